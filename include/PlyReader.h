@@ -2,7 +2,13 @@
 #include <stdint.h> 
 #include <string>
 #include <vector>
+#include <map>
+#include <functional>
+#include <utility>
+#include <stdexcept>
 #include <memory>
+#include <cstring>
+#include <assert.h>
 
 
 using namespace std;
@@ -26,7 +32,91 @@ using DATA = uint64_t;
 using VAR32 = int32_t;
 using VAR64 = int64_t;
 
+static constexpr auto PLYREADER_PROPERY_TYPE_NULL = FLAG (0X00) ;
+static constexpr auto PLYREADER_PROPERY_TYPE_VAL32 = FLAG (0X10) ;
+static constexpr auto PLYREADER_PROPERY_TYPE_VAL64 = FLAG (0X11) ;
+static constexpr auto PLYREADER_PROPERY_TYPE_VAR32 = FLAG (0X20) ;
+static constexpr auto PLYREADER_PROPERY_TYPE_VAR64 = FLAG (0X21) ;
+static constexpr auto PLYREADER_PROPERY_TYPE_BYTE = FLAG (0X30) ;
+static constexpr auto PLYREADER_PROPERY_TYPE_WORD = FLAG (0X31) ;
+static constexpr auto PLYREADER_PROPERY_TYPE_CHAR = FLAG (0X32) ;
+static constexpr auto PLYREADER_PROPERY_TYPE_DATA = FLAG (0X33) ;
+
 namespace SOLUTION {
+inline LENGTH ply_type_width (const FLAG &type) {
+	if (type == PLYREADER_PROPERY_TYPE_BYTE)
+		return 1 ;
+	if (type == PLYREADER_PROPERY_TYPE_WORD)
+		return 2 ;
+	if (type == PLYREADER_PROPERY_TYPE_VAL32 || type == PLYREADER_PROPERY_TYPE_VAR32 || type == PLYREADER_PROPERY_TYPE_CHAR)
+		return 4 ;
+	if (type == PLYREADER_PROPERY_TYPE_VAL64 || type == PLYREADER_PROPERY_TYPE_VAR64 || type == PLYREADER_PROPERY_TYPE_DATA)
+		return 8 ;
+	return 0 ;
+}
+
+template <class ARG1>
+struct PROPERTY_TYPE_TRAIT ;
+
+template <>
+struct PROPERTY_TYPE_TRAIT<VAL32> {
+	static constexpr auto value = PLYREADER_PROPERY_TYPE_VAL32 ;
+} ;
+
+template <>
+struct PROPERTY_TYPE_TRAIT<VAL64> {
+	static constexpr auto value = PLYREADER_PROPERY_TYPE_VAL64 ;
+} ;
+
+template <>
+struct PROPERTY_TYPE_TRAIT<VAR32> {
+	static constexpr auto value = PLYREADER_PROPERY_TYPE_VAR32 ;
+} ;
+
+template <>
+struct PROPERTY_TYPE_TRAIT<VAR64> {
+	static constexpr auto value = PLYREADER_PROPERY_TYPE_VAR64 ;
+} ;
+
+template <>
+struct PROPERTY_TYPE_TRAIT<BYTE> {
+	static constexpr auto value = PLYREADER_PROPERY_TYPE_BYTE ;
+} ;
+
+template <>
+struct PROPERTY_TYPE_TRAIT<WORD> {
+	static constexpr auto value = PLYREADER_PROPERY_TYPE_WORD ;
+} ;
+
+template <>
+struct PROPERTY_TYPE_TRAIT<CHAR> {
+	static constexpr auto value = PLYREADER_PROPERY_TYPE_CHAR ;
+} ;
+
+template <>
+struct PROPERTY_TYPE_TRAIT<DATA> {
+	static constexpr auto value = PLYREADER_PROPERY_TYPE_DATA ;
+} ;
+
+template <class... ARGS>
+struct RECORD_LAYOUT {
+	static constexpr LENGTH size () {
+		const LENGTH r1x[] = {0 ,LENGTH (sizeof (ARGS))...} ;
+		LENGTH ret = 0 ;
+		for (auto &&i : r1x)
+			ret += i ;
+		return ret ;
+	}
+
+	static constexpr LENGTH offset (const INDEX &index) {
+		const LENGTH r1x[] = {0 ,LENGTH (sizeof (ARGS))...} ;
+		LENGTH ret = 0 ;
+		for (INDEX i = 0 ; i < index ; ++i)
+			ret += r1x[i + 1] ;
+		return ret ;
+	}
+} ;
+
 class PlyReader {
 private:
 	using my_value_t = VALXA ;
@@ -34,6 +124,79 @@ private:
 	using my_byte_t = DATA ;
 	using my_string_t = std::string ;
 
+public:
+	struct COLUMN {
+		const BYTE *mAddress ;
+		LENGTH mSize ;
+		LENGTH mStride ;
+		FLAG mType ;
+
+		BOOL contiguous () const {
+			return mStride == ply_type_width (mType) ;
+		}
+
+		template <class ARG1>
+		const ARG1 *data () const {
+			assert (mType == PROPERTY_TYPE_TRAIT<ARG1>::value) ;
+			assert (mStride == LENGTH (sizeof (ARG1))) ;
+			return reinterpret_cast<const ARG1 *> (mAddress) ;
+		}
+
+		template <class ARG1>
+		ARG1 get (const INDEX &index) const {
+			assert (mType == PROPERTY_TYPE_TRAIT<ARG1>::value) ;
+			ARG1 ret ;
+			std::memcpy (&ret ,mAddress + index * mStride ,sizeof (ARG1)) ;
+			return ret ;
+		}
+	} ;
+
+	struct LIST {
+		const BYTE *mAddress ;
+		LENGTH mSize ;
+		FLAG mType ;
+
+		template <class ARG1>
+		const ARG1 *data () const {
+			assert (mType == PROPERTY_TYPE_TRAIT<ARG1>::value) ;
+			return reinterpret_cast<const ARG1 *> (mAddress) ;
+		}
+
+		template <class ARG1>
+		ARG1 get (const INDEX &index) const {
+			assert (mType == PROPERTY_TYPE_TRAIT<ARG1>::value) ;
+			ARG1 ret ;
+			std::memcpy (&ret ,mAddress + index * sizeof (ARG1) ,sizeof (ARG1)) ;
+			return ret ;
+		}
+	} ;
+
+	struct BATCH {
+		INDEX mLine ;
+		LENGTH mSize ;
+		vector<COLUMN> mColumn ;
+		vector<const LENGTH *> mOffset ;
+
+		LIST get_list (const INDEX &column ,const INDEX &line) const {
+			assert (mOffset[column] != NULL) ;
+			LIST ret ;
+			ret.mAddress = mColumn[column].mAddress + mOffset[column][line] * mColumn[column].mStride ;
+			ret.mSize = mOffset[column][line + 1] - mOffset[column][line] ;
+			ret.mType = mColumn[column].mType ;
+			return ret ;
+		}
+	} ;
+
+	struct OPTION {
+		BOOL mMapping = false ;
+		LENGTH mThreadCount = 1 ;
+		BOOL mLazy = false ;
+		map<string ,vector<string>> mProjection ;
+		LENGTH mBufferSize = LENGTH (1 << 20) ;
+		LENGTH mPrefetchDepth = 0 ;
+	} ;
+
+private:
 
 	class Abstract {
 	public:
@@ -43,15 +206,25 @@ private:
 		inline Abstract &operator= (const Abstract &) = delete ;
 		inline Abstract (Abstract &&) = delete ;
 		inline Abstract &operator= (Abstract &&) = delete ;
+		virtual vector<my_string_t> comment_list () const = 0 ;
+		virtual my_index_t element_count () const = 0 ;
+		virtual my_string_t element_name (const my_index_t &element_index) const = 0 ;
 		virtual my_index_t find_element (const my_string_t &name) const = 0 ;
 		virtual my_index_t element_size (const my_index_t &element_index) const = 0 ;
+		virtual my_index_t property_count (const my_index_t &element_index) const = 0 ;
+		virtual my_string_t property_name (const my_index_t &element_index ,const my_index_t &property_index) const = 0 ;
 		virtual my_index_t find_property (const my_index_t &element_index ,const my_string_t &name) const = 0 ;
-		virtual const my_value_t &get_value (const my_index_t &element_index ,const my_index_t &line_index ,const my_index_t &property_index) const = 0 ;
-		virtual const vector<my_value_t> &get_value_list (const my_index_t &element_index ,const my_index_t &line_index ,const my_index_t &property_index) const = 0 ;
-		virtual const my_index_t &get_index (const my_index_t &element_index ,const my_index_t &line_index ,const my_index_t &property_index) const = 0 ;
-		virtual const vector<my_index_t> &get_index_list (const my_index_t &element_index ,const my_index_t &line_index ,const my_index_t &property_index) const = 0 ;
-		virtual const my_byte_t &get_byte (const my_index_t &element_index ,const my_index_t &line_index ,const my_index_t &property_index) const = 0 ;
-		virtual const vector<my_byte_t> &get_byte_list (const my_index_t &element_index ,const my_index_t &line_index ,const my_index_t &property_index) const = 0 ;
+		virtual FLAG property_type (const my_index_t &element_index ,const my_index_t &property_index) const = 0 ;
+		virtual FLAG property_list_type (const my_index_t &element_index ,const my_index_t &property_index) const = 0 ;
+		virtual my_value_t get_value (const my_index_t &element_index ,const my_index_t &line_index ,const my_index_t &property_index) const = 0 ;
+		virtual vector<my_value_t> get_value_list (const my_index_t &element_index ,const my_index_t &line_index ,const my_index_t &property_index) const = 0 ;
+		virtual my_index_t get_index (const my_index_t &element_index ,const my_index_t &line_index ,const my_index_t &property_index) const = 0 ;
+		virtual vector<my_index_t> get_index_list (const my_index_t &element_index ,const my_index_t &line_index ,const my_index_t &property_index) const = 0 ;
+		virtual my_byte_t get_byte (const my_index_t &element_index ,const my_index_t &line_index ,const my_index_t &property_index) const = 0 ;
+		virtual vector<my_byte_t> get_byte_list (const my_index_t &element_index ,const my_index_t &line_index ,const my_index_t &property_index) const = 0 ;
+		virtual COLUMN get_column (const my_index_t &element_index ,const my_index_t &property_index) const = 0 ;
+		virtual const BYTE *get_address (const my_index_t &element_index ,const my_index_t &line_index ,const my_index_t &property_index) const = 0 ;
+		virtual LIST get_list (const my_index_t &element_index ,const my_index_t &line_index ,const my_index_t &property_index) const = 0 ;
 	} ;
 
 	using my_holder_t = std::shared_ptr<Abstract> ;
@@ -59,6 +232,51 @@ private:
 
 	class Implement ;
 
+public:
+	class CURSOR {
+	private:
+		std::shared_ptr<Implement> mPointer ;
+		BATCH mBatch ;
+
+	public:
+		CURSOR () = default ;
+
+		// a copy would share the stream position and the buffers behind mBatch
+		CURSOR (const CURSOR &) = delete ;
+		CURSOR &operator= (const CURSOR &) = delete ;
+		CURSOR (CURSOR &&) = default ;
+		CURSOR &operator= (CURSOR &&) = default ;
+
+		explicit CURSOR (const my_string_t &file ,const my_string_t &element ,const vector<my_string_t> &property) {
+			open (file ,element ,property ,OPTION ()) ;
+		}
+
+		explicit CURSOR (const my_string_t &file ,const my_string_t &element ,const vector<my_string_t> &property ,const OPTION &option) {
+			open (file ,element ,property ,option) ;
+		}
+
+		// streams the file of reader with the header it already parsed; the cursor keeps its
+		// own file handle and buffers, so reader is left as it was
+		explicit CURSOR (const PlyReader &reader ,const my_string_t &element ,const vector<my_string_t> &property) {
+			open (reader ,element ,property) ;
+		}
+
+		LENGTH size () const ;
+
+		INDEX line () const ;
+
+		const BATCH &next_batch (const LENGTH &max_rows) ;
+
+		// moves to another element of the same file; an element streamed to its end is not
+		// scanned again to find the one after it
+		void open_element (const my_string_t &element ,const vector<my_string_t> &property) ;
+
+	private:
+		void open (const my_string_t &file ,const my_string_t &element ,const vector<my_string_t> &property ,const OPTION &option) ;
+
+		void open (const PlyReader &reader ,const my_string_t &element ,const vector<my_string_t> &property) ;
+	} ;
+
 private:
 	my_holder_t mPointer ;
 	
@@ -66,7 +284,27 @@ public:
 	PlyReader () = default ;
 
 	explicit PlyReader (const my_string_t &file) {
-		mPointer = create (file) ;
+		mPointer = create (file ,OPTION ()) ;
+	}
+
+	explicit PlyReader (const my_string_t &file ,const OPTION &option) {
+		mPointer = create (file ,option) ;
+	}
+
+	// text of the comment lines of the header, in order
+	vector<my_string_t> comment_list () const {
+		check_avaliable (mPointer) ;
+		return mPointer->comment_list () ;
+	}
+
+	my_index_t element_count () const {
+		check_avaliable (mPointer) ;
+		return mPointer->element_count () ;
+	}
+
+	my_string_t element_name (const my_index_t &element_index) const {
+		check_avaliable (mPointer) ;
+		return mPointer->element_name (element_index) ;
 	}
 
 	my_index_t find_element (const my_string_t &name) const {
@@ -79,45 +317,152 @@ public:
 		return mPointer->element_size (element_index) ;
 	}
 
+	// counts every property in the header, including ones a projection hides
+	my_index_t property_count (const my_index_t &element_index) const {
+		check_avaliable (mPointer) ;
+		return mPointer->property_count (element_index) ;
+	}
+
+	my_string_t property_name (const my_index_t &element_index ,const my_index_t &property_index) const {
+		check_avaliable (mPointer) ;
+		return mPointer->property_name (element_index ,property_index) ;
+	}
+
 	my_index_t find_property (const my_index_t &element_index ,const my_string_t &name) const {
 		check_avaliable (mPointer) ;
 		return mPointer->find_property (element_index ,name) ;
 	}
 
-	const my_value_t &get_value (const my_index_t &element_index ,const my_index_t &line_index ,const my_index_t &property_index) const {
+	FLAG property_type (const my_index_t &element_index ,const my_index_t &property_index) const {
+		check_avaliable (mPointer) ;
+		return mPointer->property_type (element_index ,property_index) ;
+	}
+
+	FLAG property_list_type (const my_index_t &element_index ,const my_index_t &property_index) const {
+		check_avaliable (mPointer) ;
+		return mPointer->property_list_type (element_index ,property_index) ;
+	}
+
+	my_value_t get_value (const my_index_t &element_index ,const my_index_t &line_index ,const my_index_t &property_index) const {
 		check_avaliable (mPointer) ;
 		return mPointer->get_value (element_index ,line_index ,property_index) ;
 	}
 
-	const vector<my_value_t> &get_value_list (const my_index_t &element_index ,const my_index_t &line_index ,const my_index_t &property_index) const {
+	vector<my_value_t> get_value_list (const my_index_t &element_index ,const my_index_t &line_index ,const my_index_t &property_index) const {
 		check_avaliable (mPointer) ;
 		return mPointer->get_value_list (element_index ,line_index ,property_index) ;
 	}
 
-	const my_index_t &get_index (const my_index_t &element_index ,const my_index_t &line_index ,const my_index_t &property_index) const {
+	my_index_t get_index (const my_index_t &element_index ,const my_index_t &line_index ,const my_index_t &property_index) const {
 		check_avaliable (mPointer) ;
 		return mPointer->get_index (element_index ,line_index ,property_index) ;
 	}
 
-	const vector<my_index_t> &get_index_list (const my_index_t &element_index ,const my_index_t &line_index ,const my_index_t &property_index) const {
+	vector<my_index_t> get_index_list (const my_index_t &element_index ,const my_index_t &line_index ,const my_index_t &property_index) const {
 		check_avaliable (mPointer) ;
 		return mPointer->get_index_list (element_index ,line_index ,property_index) ;
 	}
 
-	const my_byte_t &get_byte (const my_index_t &element_index ,const my_index_t &line_index ,const my_index_t &property_index) const {
+	my_byte_t get_byte (const my_index_t &element_index ,const my_index_t &line_index ,const my_index_t &property_index) const {
 		check_avaliable (mPointer) ;
 		return mPointer->get_byte (element_index ,line_index ,property_index) ;
 	}
 
-	const vector<my_byte_t> &get_byte_list (const my_index_t &element_index ,const my_index_t &line_index ,const my_index_t &property_index) const {
+	vector<my_byte_t> get_byte_list (const my_index_t &element_index ,const my_index_t &line_index ,const my_index_t &property_index) const {
 		check_avaliable (mPointer) ;
 		return mPointer->get_byte_list (element_index ,line_index ,property_index) ;
 	}
 
+	COLUMN get_column (const my_index_t &element_index ,const my_index_t &property_index) const {
+		check_avaliable (mPointer) ;
+		return mPointer->get_column (element_index ,property_index) ;
+	}
+
+	LIST get_list (const my_index_t &element_index ,const my_index_t &line_index ,const my_index_t &property_index) const {
+		check_avaliable (mPointer) ;
+		return mPointer->get_list (element_index ,line_index ,property_index) ;
+	}
+
+	template <class ARG1>
+	ARG1 get_typed (const my_index_t &element_index ,const my_index_t &line_index ,const my_index_t &property_index) const {
+		check_avaliable (mPointer) ;
+		assert (mPointer->property_list_type (element_index ,property_index) == PLYREADER_PROPERY_TYPE_NULL) ;
+		assert (mPointer->property_type (element_index ,property_index) == PROPERTY_TYPE_TRAIT<ARG1>::value) ;
+		ARG1 ret ;
+		std::memcpy (&ret ,mPointer->get_address (element_index ,line_index ,property_index) ,sizeof (ARG1)) ;
+		return ret ;
+	}
+
+	template <class ARG1>
+	vector<ARG1> get_typed_list (const my_index_t &element_index ,const my_index_t &line_index ,const my_index_t &property_index) const {
+		check_avaliable (mPointer) ;
+		assert (mPointer->property_list_type (element_index ,property_index) == PROPERTY_TYPE_TRAIT<ARG1>::value) ;
+		const auto r1x = mPointer->get_list (element_index ,line_index ,property_index) ;
+		vector<ARG1> ret (r1x.mSize) ;
+		if (!ret.empty ())
+			std::memcpy (ret.data () ,r1x.mAddress ,ret.size () * sizeof (ARG1)) ;
+		return ret ;
+	}
+
+	void read_into (const my_index_t &element_index ,const vector<my_string_t> &property ,void *dst ,const LENGTH &stride ,const vector<FLAG> &type) const ;
+
+	void read_into (const my_index_t &element_index ,const vector<my_string_t> &property ,void *dst ,const LENGTH &stride) const ;
+
+	// fills records laid out as ARGS... packed in order; when every property is stored in exactly
+	// the declared type the copy is a compile-time unrolled kernel, otherwise read_into converts.
+	// returns whether the header matched the declared layout
+	template <class... ARGS>
+	BOOL read_record (const my_index_t &element_index ,const vector<my_string_t> &property ,void *dst ,const LENGTH &stride) const {
+		check_avaliable (mPointer) ;
+		if (property.size () != sizeof... (ARGS))
+			throw std::invalid_argument ("Property list does not match the record layout") ;
+		if (stride < RECORD_LAYOUT<ARGS...>::size ())
+			throw std::invalid_argument ("Record stride too small for requested properties") ;
+
+		COLUMN r1x[sizeof... (ARGS)] ;
+		const FLAG r2x[] = {PROPERTY_TYPE_TRAIT<ARGS>::value...} ;
+		BOOL r3x = true ;
+		for (INDEX i = 0 ; i < (INDEX)property.size () ; ++i)
+		{
+			const auto r4x = mPointer->find_property (element_index ,property[i]) ;
+			if (r4x == -1)
+				throw std::invalid_argument ("Unknown property: " + property[i]) ;
+			if (mPointer->property_list_type (element_index ,r4x) != PLYREADER_PROPERY_TYPE_NULL || mPointer->property_type (element_index ,r4x) != r2x[i])
+			{
+				r3x = false ;
+				break ;
+			}
+			r1x[i] = mPointer->get_column (element_index ,r4x) ;
+		}
+		if (!r3x)
+		{
+			read_into (element_index ,property ,dst ,stride ,vector<FLAG> (std::begin (r2x) ,std::end (r2x))) ;
+			return false ;
+		}
+
+		const auto r5x = mPointer->element_size (element_index) ;
+		const auto r6x = static_cast<BYTE *> (dst) ;
+		for (INDEX k = 0 ; k < r5x ; ++k)
+			copy_record<ARGS...> (r1x ,k ,r6x + k * stride ,std::index_sequence_for<ARGS...> ()) ;
+		return true ;
+	}
+
+	static void visit (const my_string_t &file ,const my_string_t &element ,const vector<my_string_t> &property ,const LENGTH &batch ,const std::function<void (const BATCH &)> &func) {
+		visit (file ,element ,property ,batch ,func ,OPTION ()) ;
+	}
+
+	static void visit (const my_string_t &file ,const my_string_t &element ,const vector<my_string_t> &property ,const LENGTH &batch ,const std::function<void (const BATCH &)> &func ,const OPTION &option) ;
+
 private:
+	template <class... ARGS ,std::size_t... ARG2>
+	static void copy_record (const COLUMN *column ,const INDEX &line ,BYTE *dst ,std::index_sequence<ARG2...>) {
+		const int r1x[] = {0 ,(std::memcpy (dst + RECORD_LAYOUT<ARGS...>::offset (ARG2) ,column[ARG2].mAddress + line * column[ARG2].mStride ,sizeof (ARGS)) ,0)...} ;
+		(void) r1x ;
+	}
+
 	static void check_avaliable (const my_holder_t &pointer) ;
 
-	static my_holder_t create (const my_string_t &file) ;
+	static my_holder_t create (const my_string_t &file ,const OPTION &option) ;
 } ;
 
 } ;
@@ -0,0 +1,99 @@
+#pragma once
+#include "PlyReader.h"
+
+namespace SOLUTION {
+// collects an element schema and pointers to caller-owned columns, lists or interleaved
+// records, then encodes every element into large blocks on write. the data must stay alive
+// until write returns, or in streaming mode until the append_rows call that reads it
+class PlyWriter {
+private:
+	using my_index_t = INDEX ;
+	using my_string_t = std::string ;
+
+public:
+	struct OPTION {
+		my_string_t mFormat = "binary_little_endian" ;
+		LENGTH mBufferSize = LENGTH (1 << 20) ;
+		LENGTH mThreadCount = 1 ;
+	} ;
+
+	// mProjection keeps elements and properties as in PlyReader::OPTION; mType stores the
+	// named properties (list values for lists) in another type, failing on values an integer
+	// type cannot hold exactly; mNarrowReal stores double as float and mNarrowColor float
+	// colors as uchar
+	struct REWRITE {
+		map<string ,vector<string>> mProjection ;
+		map<string ,map<string ,FLAG>> mType ;
+		BOOL mNarrowReal = false ;
+		BOOL mNarrowColor = false ;
+	} ;
+
+private:
+	class Implement ;
+
+	std::shared_ptr<Implement> mPointer ;
+
+public:
+	PlyWriter () = default ;
+
+	explicit PlyWriter (const my_string_t &file) {
+		mPointer = create (file ,OPTION ()) ;
+	}
+
+	explicit PlyWriter (const my_string_t &file ,const OPTION &option) {
+		mPointer = create (file ,option) ;
+	}
+
+	void add_comment (const my_string_t &comment) ;
+
+	// a size of -1 is counted by append_rows and filled into the header by close
+	my_index_t add_element (const my_string_t &name ,const LENGTH &size) ;
+
+	my_index_t add_property (const my_index_t &element_index ,const my_string_t &name ,const FLAG &type) ;
+
+	my_index_t add_list_property (const my_index_t &element_index ,const my_string_t &name ,const FLAG &size_type ,const FLAG &type) ;
+
+	// source values of type are read every stride bytes and converted to the declared type
+	void set_column (const my_index_t &element_index ,const my_index_t &property_index ,const void *src ,const LENGTH &stride ,const FLAG &type) ;
+
+	// rows of list line are src[offset[line]] up to src[offset[line + 1]], as in BATCH
+	void set_list (const my_index_t &element_index ,const my_index_t &property_index ,const LENGTH *offset ,const void *src ,const FLAG &type) ;
+
+	// binds records holding the named properties packed in order in their declared types
+	void set_record (const my_index_t &element_index ,const vector<my_string_t> &property ,const void *src ,const LENGTH &stride) ;
+
+	template <class ARG1>
+	void set_column (const my_index_t &element_index ,const my_index_t &property_index ,const ARG1 *src ,const LENGTH &stride = LENGTH (sizeof (ARG1))) {
+		set_column (element_index ,property_index ,static_cast<const void *> (src) ,stride ,FLAG (PROPERTY_TYPE_TRAIT<ARG1>::value)) ;
+	}
+
+	template <class ARG1>
+	void set_list (const my_index_t &element_index ,const my_index_t &property_index ,const LENGTH *offset ,const ARG1 *src) {
+		set_list (element_index ,property_index ,offset ,static_cast<const void *> (src) ,FLAG (PROPERTY_TYPE_TRAIT<ARG1>::value)) ;
+	}
+
+	// emits the header and every element, then closes the file
+	void write () ;
+
+	// encodes the next size rows of the element from the data bound now; elements are
+	// appended in declaration order and memory stays bounded by the buffer size
+	void append_rows (const my_index_t &element_index ,const LENGTH &size) ;
+
+	// ends an append_rows stream, checking declared sizes and patching counted ones
+	void close () ;
+
+	// re-encodes src into file in option.mFormat, passing one batch of rows at a time from a
+	// reader cursor to append_rows so memory stays bounded whatever the file size
+	static void convert (const my_string_t &src ,const my_string_t &file ,const OPTION &option) ;
+
+	// convert that also drops and narrows properties as described by REWRITE, in the same
+	// single streaming pass
+	static void rewrite (const my_string_t &src ,const my_string_t &file ,const OPTION &option ,const REWRITE &rewrite) ;
+
+private:
+	static void check_avaliable (const std::shared_ptr<Implement> &pointer) ;
+
+	static std::shared_ptr<Implement> create (const my_string_t &file ,const OPTION &option) ;
+} ;
+
+} ;
@@ -0,0 +1,126 @@
+#ifndef UTIL_FORMATTER_HEADER
+#define UTIL_FORMATTER_HEADER
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#include "parser.h"
+
+
+namespace util {
+namespace formatter {
+
+
+/* Upper bound of the characters written for one number, sign included. */
+static constexpr int MAX_NUMBER_LENGTH = 32;
+
+
+template <typename T>
+char* format_integer (char* pos, T value);
+
+
+template <typename T>
+char* format_float (char* pos, T value);
+
+
+template <typename T>
+char* format_number (char* pos, T value);
+
+
+template <typename T>
+inline char*
+format_integer (char* pos, T value)
+{
+    uint64_t magnitude = uint64_t(value);
+    if (std::is_signed<T>::value && value < 0)
+    {
+        *pos++ = '-';
+        magnitude = 0 - magnitude;
+    }
+
+    char digits[20];
+    int count = 0;
+    do
+    {
+        digits[count++] = char('0' + magnitude % 10);
+        magnitude /= 10;
+    }
+    while (magnitude != 0);
+    while (count > 0)
+        *pos++ = digits[--count];
+    return pos;
+}
+
+/*
+ * Replaces the LC_NUMERIC decimal point snprintf may have written with '.'.
+ * Besides it "%g" only emits digits, signs and the letters of exponents,
+ * inf and nan, so the first other run of bytes is the decimal point.
+ */
+inline int
+c_decimal_point (char* pos, int length)
+{
+    for (int i = 0; i < length; ++i)
+    {
+        char const c = pos[i];
+        if ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.'
+            || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'))
+            continue;
+        int point_end = i + 1;
+        while (point_end < length && (pos[point_end] < '0' || pos[point_end] > '9'))
+            ++point_end;
+        pos[i] = '.';
+        std::memmove(pos + i + 1, pos + point_end, std::size_t(length - point_end));
+        return length - (point_end - i - 1);
+    }
+    return length;
+}
+
+/*
+ * Writes the shortest of the digits10 and max_digits10 representations
+ * that parses back to the same value, so common values stay short and
+ * every value survives a round trip through parse_float.
+ */
+template <typename T>
+inline char*
+format_float (char* pos, T value)
+{
+    int length = c_decimal_point(pos, std::snprintf(pos, MAX_NUMBER_LENGTH,
+        "%.*g", std::numeric_limits<T>::digits10, double(value)));
+    T check;
+    if (util::parser::parse_float(pos, pos + length, &check) != pos + length
+        || check != value)
+    {
+        length = c_decimal_point(pos, std::snprintf(pos, MAX_NUMBER_LENGTH,
+            "%.*g", std::numeric_limits<T>::max_digits10, double(value)));
+    }
+    return pos + length;
+}
+
+template <typename T>
+inline char*
+format_number (char* pos, T value, std::true_type)
+{
+    return format_float(pos, value);
+}
+
+template <typename T>
+inline char*
+format_number (char* pos, T value, std::false_type)
+{
+    return format_integer(pos, value);
+}
+
+template <typename T>
+inline char*
+format_number (char* pos, T value)
+{
+    return format_number(pos, value, std::is_floating_point<T>());
+}
+
+}
+}
+
+#endif /* UTIL_FORMATTER_HEADER */
@@ -0,0 +1,286 @@
+#ifndef UTIL_PARSER_HEADER
+#define UTIL_PARSER_HEADER
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <locale.h>
+#include <string>
+#include <type_traits>
+#if defined(__APPLE__)
+#   include <xlocale.h>
+#endif
+
+
+namespace util {
+namespace parser {
+
+
+bool is_whitespace (char c);
+
+
+char const* skip_whitespaces (char const* pos, char const* end);
+
+
+template <typename T>
+char const* parse_integer (char const* pos, char const* end, T* value);
+
+
+template <typename T>
+char const* parse_float (char const* pos, char const* end, T* value);
+
+
+template <typename T>
+char const* parse_number (char const* pos, char const* end, T* value);
+
+
+inline bool
+is_whitespace (char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r'
+        || c == '\v' || c == '\f';
+}
+
+inline char const*
+skip_whitespaces (char const* pos, char const* end)
+{
+    while (pos < end && is_whitespace(*pos))
+        ++pos;
+    return pos;
+}
+
+template <typename T>
+inline char const*
+parse_integer (char const* pos, char const* end, T* value)
+{
+    bool negative = false;
+    if (pos < end && (*pos == '-' || *pos == '+'))
+    {
+        negative = (*pos == '-');
+        ++pos;
+    }
+    if (negative && !std::is_signed<T>::value)
+        return nullptr;
+
+    char const* digits = pos;
+    uint64_t magnitude = 0;
+    for (; pos < end && *pos >= '0' && *pos <= '9'; ++pos)
+    {
+        uint64_t const digit = uint64_t(*pos - '0');
+        if (magnitude > (UINT64_MAX - digit) / 10)
+            return nullptr;
+        magnitude = magnitude * 10 + digit;
+    }
+    if (pos == digits)
+        return nullptr;
+
+    uint64_t const limit = negative
+        ? uint64_t(std::numeric_limits<T>::max()) + 1
+        : uint64_t(std::numeric_limits<T>::max());
+    if (magnitude > limit)
+        return nullptr;
+
+    *value = negative ? T(0 - magnitude) : T(magnitude);
+    return pos;
+}
+
+/*
+ * Exact powers of ten for the fast path; 1e22 is the largest exact double
+ * and 1e10 the largest exact float.
+ */
+inline double
+exact_power_of_ten (int exponent)
+{
+    static double const table[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    return table[exponent];
+}
+
+/*
+ * The "C" locale for the strtod/strtof fallback, so a comma LC_NUMERIC
+ * does not cut tokens short at the decimal point.
+ */
+#if defined(_WIN32)
+inline _locale_t
+c_locale (void)
+{
+    static _locale_t const locale = _create_locale(LC_ALL, "C");
+    return locale;
+}
+
+inline float
+strtof_c (char const* str, char** str_end)
+{
+    return _strtof_l(str, str_end, c_locale());
+}
+
+inline double
+strtod_c (char const* str, char** str_end)
+{
+    return _strtod_l(str, str_end, c_locale());
+}
+#else
+inline locale_t
+c_locale (void)
+{
+    static locale_t const locale = newlocale(LC_ALL_MASK, "C", locale_t(0));
+    return locale;
+}
+
+inline float
+strtof_c (char const* str, char** str_end)
+{
+    return strtof_l(str, str_end, c_locale());
+}
+
+inline double
+strtod_c (char const* str, char** str_end)
+{
+    return strtod_l(str, str_end, c_locale());
+}
+#endif
+
+template <typename T>
+inline char const*
+parse_float (char const* pos, char const* end, T* value)
+{
+    char const* start = pos;
+    bool negative = false;
+    if (pos < end && (*pos == '-' || *pos == '+'))
+    {
+        negative = (*pos == '-');
+        ++pos;
+    }
+
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool any_digit = false;
+    bool exact = true;
+    for (; pos < end && *pos >= '0' && *pos <= '9'; ++pos)
+    {
+        any_digit = true;
+        if (digits < 19)
+        {
+            mantissa = mantissa * 10 + uint64_t(*pos - '0');
+            digits += (mantissa != 0);
+        }
+        else
+        {
+            exponent += 1;
+            exact = exact && (*pos == '0');
+        }
+    }
+    if (pos < end && *pos == '.')
+    {
+        ++pos;
+        for (; pos < end && *pos >= '0' && *pos <= '9'; ++pos)
+        {
+            any_digit = true;
+            if (digits < 19)
+            {
+                mantissa = mantissa * 10 + uint64_t(*pos - '0');
+                digits += (mantissa != 0);
+                exponent -= 1;
+            }
+            else
+            {
+                exact = exact && (*pos == '0');
+            }
+        }
+    }
+
+    if (!any_digit)
+    {
+        /* nan, inf and infinity in any case go through the C library. */
+        char const* word = pos;
+        while (pos < end && ((*pos | 0x20) >= 'a' && (*pos | 0x20) <= 'z'))
+            ++pos;
+        if (pos == word)
+            return nullptr;
+        exact = false;
+    }
+    else if (pos < end && (*pos == 'e' || *pos == 'E'))
+    {
+        int exp_value = 0;
+        char const* exp_end = parse_integer(pos + 1, end, &exp_value);
+        if (exp_end == nullptr)
+            return nullptr;
+        exponent += exp_value;
+        pos = exp_end;
+    }
+
+    /*
+     * Clinger's fast path: a mantissa that fits the significand of T
+     * scaled by a power of ten exact in T is correctly rounded by a
+     * single IEEE multiplication or division carried out in T, so a float
+     * is never rounded through a double first. Everything else is
+     * delegated to strtod/strtof in the C locale on a NUL-terminated copy
+     * of the token.
+     */
+    int const max_exponent = std::is_same<T, float>::value ? 10 : 22;
+    if (exact && mantissa <= (uint64_t(1) << std::numeric_limits<T>::digits)
+        && exponent >= -max_exponent && exponent <= max_exponent)
+    {
+        T result = T(mantissa);
+        if (exponent < 0)
+            result /= T(exact_power_of_ten(-exponent));
+        else
+            result *= T(exact_power_of_ten(exponent));
+        *value = negative ? -result : result;
+        return pos;
+    }
+
+    std::size_t const length = std::size_t(pos - start);
+    char stack_buffer[64];
+    std::string heap_buffer;
+    char* token = stack_buffer;
+    if (length >= sizeof(stack_buffer))
+    {
+        heap_buffer.assign(start, length);
+        token = &heap_buffer[0];
+    }
+    else
+    {
+        std::memcpy(stack_buffer, start, length);
+        stack_buffer[length] = '\0';
+    }
+
+    char* token_end = nullptr;
+    if (std::is_same<T, float>::value)
+        *value = T(strtof_c(token, &token_end));
+    else
+        *value = T(strtod_c(token, &token_end));
+    if (token_end != token + length)
+        return nullptr;
+    return pos;
+}
+
+template <typename T>
+inline char const*
+parse_number (char const* pos, char const* end, T* value, std::true_type)
+{
+    return parse_float(pos, end, value);
+}
+
+template <typename T>
+inline char const*
+parse_number (char const* pos, char const* end, T* value, std::false_type)
+{
+    return parse_integer(pos, end, value);
+}
+
+template <typename T>
+inline char const*
+parse_number (char const* pos, char const* end, T* value)
+{
+    return parse_number(pos, end, value, std::is_floating_point<T>());
+}
+
+}
+}
+
+#endif /* UTIL_PARSER_HEADER */
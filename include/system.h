@@ -8,6 +8,9 @@
 #include <chrono>
 #include <vector>
 #include <istream>
+#include <algorithm>
+#include <exception>
+#include <string>
 
 
 namespace util {
@@ -39,11 +42,59 @@ void signal_segfault_handler (int code);
 
 void print_stack_trace (void);
 
+/* Moves from over to, replacing an existing to; false with errno set on failure. */
+bool replace_file (std::string const& from, std::string const& to);
+
+
+class MappedFile
+{
+public:
+    MappedFile (void);
+    ~MappedFile (void);
+    MappedFile (MappedFile const&) = delete;
+    MappedFile& operator= (MappedFile const&) = delete;
+
+    bool open (std::string const& filename);
+    void close (void);
+
+    char const* data (void) const;
+    std::size_t size (void) const;
+
+private:
+    void* address;
+    std::size_t length;
+};
+
+/* Writes at explicit offsets, so several threads can fill disjoint ranges. */
+class PositionalFile
+{
+public:
+    PositionalFile (void);
+    ~PositionalFile (void);
+    PositionalFile (PositionalFile const&) = delete;
+    PositionalFile& operator= (PositionalFile const&) = delete;
+
+    bool open (std::string const& filename);
+    void close (void);
+
+    bool write (void const* data, std::size_t size, std::size_t offset);
+
+private:
+    int handle;
+};
+
+template <typename F>
+inline void
+parallel_for (std::size_t count, std::size_t threads, F const& func);
 
 template <int N>
 inline void
 byte_swap (char* data);
 
+template <int N>
+void
+byte_swap_block (char* data, std::size_t count);
+
 template <typename T>
 inline T
 letoh (T const& x);
@@ -93,6 +144,64 @@ rand_int (void)
     return std::rand();
 }
 
+template <typename F>
+inline void
+parallel_for (std::size_t count, std::size_t threads, F const& func)
+{
+    threads = std::min(threads, count);
+    if (threads <= 1)
+    {
+        func(std::size_t(0), count);
+        return;
+    }
+
+    std::size_t const chunk = (count + threads - 1) / threads;
+    std::vector<std::exception_ptr> errors(threads);
+    std::vector<std::thread> workers;
+    for (std::size_t t = 1; t < threads && t * chunk < count; ++t)
+    {
+        std::size_t const begin = t * chunk;
+        std::size_t const end = std::min(count, begin + chunk);
+        workers.emplace_back([&func, &errors, t, begin, end]
+        {
+            try
+            {
+                func(begin, end);
+            }
+            catch (...)
+            {
+                errors[t] = std::current_exception();
+            }
+        });
+    }
+
+    try
+    {
+        func(std::size_t(0), std::min(count, chunk));
+    }
+    catch (...)
+    {
+        errors[0] = std::current_exception();
+    }
+    for (std::size_t t = 0; t < workers.size(); ++t)
+        workers[t].join();
+    for (std::size_t t = 0; t < errors.size(); ++t)
+        if (errors[t])
+            std::rethrow_exception(errors[t]);
+}
+
+inline char const*
+MappedFile::data (void) const
+{
+    return static_cast<char const*>(this->address);
+}
+
+inline std::size_t
+MappedFile::size (void) const
+{
+    return this->length;
+}
+
 inline void
 print_build_timestamp (char const* application_name)
 {
@@ -139,6 +248,12 @@ print_build_timestamp (char const* application_name)
 #   endif
 #endif
 
+template <>
+inline void
+byte_swap<1> (char* /*data*/)
+{
+}
+
 template <>
 inline void
 byte_swap<2> (char* data)
@@ -164,6 +279,24 @@ byte_swap<8> (char* data)
     std::swap(data[3], data[4]);
 }
 
+template <>
+inline void
+byte_swap_block<1> (char* /*data*/, std::size_t /*count*/)
+{
+}
+
+template <>
+void
+byte_swap_block<2> (char* data, std::size_t count);
+
+template <>
+void
+byte_swap_block<4> (char* data, std::size_t count);
+
+template <>
+void
+byte_swap_block<8> (char* data, std::size_t count);
+
 #if defined(HOST_BYTEORDER_LE) && defined(HOST_BYTEORDER_BE)
 #   error "Host endianess can not be both LE and BE!"
 #elif defined(HOST_BYTEORDER_LE)
@@ -0,0 +1,457 @@
+#pragma once
+#include "PlyReader.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include <cstring>
+#include <stdexcept>
+#include "system.h"
+#include "formatter.h"
+
+enum PLYFormat
+{
+    PLY_ASCII,
+    PLY_BINARY_LE,
+    PLY_BINARY_BE,
+    PLY_UNKNOWN
+};
+
+#if defined(HOST_BYTEORDER_LE)
+static constexpr auto PLY_BINARY_HOST = PLY_BINARY_LE ;
+#else
+static constexpr auto PLY_BINARY_HOST = PLY_BINARY_BE ;
+#endif
+
+using ply_decode_t = void (*) (BYTE const* src, BYTE* dest);
+
+
+template <int N, bool SWAP>
+void ply_decode_cell (BYTE const* src, BYTE* dest)
+{
+    std::memcpy(dest, src, N);
+    if (SWAP)
+        util::system::byte_swap<N>(reinterpret_cast<char*>(dest));
+}
+
+
+template <bool SWAP>
+ply_decode_t ply_decoder (LENGTH width)
+{
+    switch (width)
+    {
+        case 1:
+            return &ply_decode_cell<1, false>;
+        case 2:
+            return &ply_decode_cell<2, SWAP>;
+        case 4:
+            return &ply_decode_cell<4, SWAP>;
+        case 8:
+            return &ply_decode_cell<8, SWAP>;
+        default:
+            throw std::invalid_argument("Invalid property width");
+    }
+}
+
+
+using ply_count_t = LENGTH (*) (BYTE const* src);
+
+
+template <typename T, bool SWAP>
+LENGTH ply_decode_count (BYTE const* src)
+{
+    T value;
+    std::memcpy(&value, src, sizeof(T));
+    if (SWAP)
+        util::system::byte_swap<sizeof(T)>(reinterpret_cast<char*>(&value));
+    return LENGTH(value);
+}
+
+
+template <bool SWAP>
+ply_count_t ply_counter (FLAG type)
+{
+    switch (type)
+    {
+        case PLYREADER_PROPERY_TYPE_VAR32:
+            return &ply_decode_count<VAR32, SWAP>;
+        case PLYREADER_PROPERY_TYPE_VAR64:
+            return &ply_decode_count<VAR64, SWAP>;
+        case PLYREADER_PROPERY_TYPE_BYTE:
+            return &ply_decode_count<BYTE, SWAP>;
+        case PLYREADER_PROPERY_TYPE_WORD:
+            return &ply_decode_count<WORD, SWAP>;
+        case PLYREADER_PROPERY_TYPE_CHAR:
+            return &ply_decode_count<CHAR, SWAP>;
+        case PLYREADER_PROPERY_TYPE_DATA:
+            return &ply_decode_count<DATA, SWAP>;
+        default:
+            throw std::invalid_argument("Invalid list size type");
+    }
+}
+
+
+template <typename S, typename T>
+T ply_load_value (BYTE const* src)
+{
+    S value;
+    std::memcpy(&value, src, sizeof(S));
+    return T(value);
+}
+
+
+template <typename T>
+T ply_load_scalar (BYTE const* src, FLAG type)
+{
+    switch (type)
+    {
+        case PLYREADER_PROPERY_TYPE_VAL32:
+            return ply_load_value<VAL32, T>(src);
+        case PLYREADER_PROPERY_TYPE_VAL64:
+            return ply_load_value<VAL64, T>(src);
+        case PLYREADER_PROPERY_TYPE_VAR32:
+            return ply_load_value<VAR32, T>(src);
+        case PLYREADER_PROPERY_TYPE_VAR64:
+            return ply_load_value<VAR64, T>(src);
+        case PLYREADER_PROPERY_TYPE_BYTE:
+            return ply_load_value<BYTE, T>(src);
+        case PLYREADER_PROPERY_TYPE_WORD:
+            return ply_load_value<WORD, T>(src);
+        case PLYREADER_PROPERY_TYPE_CHAR:
+            return ply_load_value<CHAR, T>(src);
+        case PLYREADER_PROPERY_TYPE_DATA:
+            return ply_load_value<DATA, T>(src);
+        default:
+            throw std::invalid_argument("Invalid property type");
+    }
+}
+
+
+using ply_convert_t = void (*) (BYTE const* src, LENGTH src_stride, BYTE* dest, LENGTH dest_stride, LENGTH count);
+
+
+template <typename S, typename T>
+void ply_convert_column (BYTE const* src, LENGTH src_stride, BYTE* dest, LENGTH dest_stride, LENGTH count)
+{
+    for (LENGTH i = 0; i < count; ++i)
+    {
+        S value;
+        std::memcpy(&value, src + i * src_stride, sizeof(S));
+        T const result = static_cast<T>(value);
+        std::memcpy(dest + i * dest_stride, &result, sizeof(T));
+    }
+}
+
+
+template <typename S>
+ply_convert_t ply_converter (FLAG dest_type)
+{
+    switch (dest_type)
+    {
+        case PLYREADER_PROPERY_TYPE_VAL32:
+            return &ply_convert_column<S, VAL32>;
+        case PLYREADER_PROPERY_TYPE_VAL64:
+            return &ply_convert_column<S, VAL64>;
+        case PLYREADER_PROPERY_TYPE_VAR32:
+            return &ply_convert_column<S, VAR32>;
+        case PLYREADER_PROPERY_TYPE_VAR64:
+            return &ply_convert_column<S, VAR64>;
+        case PLYREADER_PROPERY_TYPE_BYTE:
+            return &ply_convert_column<S, BYTE>;
+        case PLYREADER_PROPERY_TYPE_WORD:
+            return &ply_convert_column<S, WORD>;
+        case PLYREADER_PROPERY_TYPE_CHAR:
+            return &ply_convert_column<S, CHAR>;
+        case PLYREADER_PROPERY_TYPE_DATA:
+            return &ply_convert_column<S, DATA>;
+        default:
+            throw std::invalid_argument("Invalid property type");
+    }
+}
+
+
+inline ply_convert_t ply_converter (FLAG src_type, FLAG dest_type)
+{
+    switch (src_type)
+    {
+        case PLYREADER_PROPERY_TYPE_VAL32:
+            return ply_converter<VAL32>(dest_type);
+        case PLYREADER_PROPERY_TYPE_VAL64:
+            return ply_converter<VAL64>(dest_type);
+        case PLYREADER_PROPERY_TYPE_VAR32:
+            return ply_converter<VAR32>(dest_type);
+        case PLYREADER_PROPERY_TYPE_VAR64:
+            return ply_converter<VAR64>(dest_type);
+        case PLYREADER_PROPERY_TYPE_BYTE:
+            return ply_converter<BYTE>(dest_type);
+        case PLYREADER_PROPERY_TYPE_WORD:
+            return ply_converter<WORD>(dest_type);
+        case PLYREADER_PROPERY_TYPE_CHAR:
+            return ply_converter<CHAR>(dest_type);
+        case PLYREADER_PROPERY_TYPE_DATA:
+            return ply_converter<DATA>(dest_type);
+        default:
+            throw std::invalid_argument("Invalid property type");
+    }
+}
+
+
+using ply_gather_t = void (*) (BYTE const* src, LENGTH src_stride, BYTE* dest, LENGTH count);
+
+
+using ply_swap_t = void (*) (BYTE* data, LENGTH count);
+
+
+template <int N>
+void ply_swap_column (BYTE* data, LENGTH count)
+{
+    util::system::byte_swap_block<N>(reinterpret_cast<char*>(data), count);
+}
+
+
+inline ply_swap_t ply_swapper (LENGTH width)
+{
+    switch (width)
+    {
+        case 2:
+            return &ply_swap_column<2>;
+        case 4:
+            return &ply_swap_column<4>;
+        case 8:
+            return &ply_swap_column<8>;
+        default:
+            return NULL;
+    }
+}
+
+
+template <int N, bool SWAP>
+void ply_gather_column (BYTE const* src, LENGTH src_stride, BYTE* dest, LENGTH count)
+{
+    for (LENGTH i = 0; i < count; ++i)
+        std::memcpy(dest + i * N, src + i * src_stride, N);
+    if (SWAP)
+        util::system::byte_swap_block<N>(reinterpret_cast<char*>(dest), count);
+}
+
+
+template <bool SWAP>
+ply_gather_t ply_gatherer (LENGTH width)
+{
+    switch (width)
+    {
+        case 1:
+            return &ply_gather_column<1, false>;
+        case 2:
+            return &ply_gather_column<2, SWAP>;
+        case 4:
+            return &ply_gather_column<4, SWAP>;
+        case 8:
+            return &ply_gather_column<8, SWAP>;
+        default:
+            throw std::invalid_argument("Invalid property width");
+    }
+}
+
+
+using ply_fit_t = bool (*) (BYTE const* src, LENGTH src_stride, LENGTH count);
+
+
+template <typename S, typename T>
+bool ply_fit_column (BYTE const* src, LENGTH src_stride, LENGTH count)
+{
+    for (LENGTH i = 0; i < count; ++i)
+    {
+        S value;
+        std::memcpy(&value, src + i * src_stride, sizeof(S));
+        T const result = static_cast<T>(value);
+        if (static_cast<S>(result) != value || (value < S(0)) != (result < T(0)))
+            return false;
+    }
+    return true;
+}
+
+
+// real values fit when they are integral and inside the range of T; the bounds are powers of
+// two, exact in S, so NaN, infinities and values the cast would not define all fail
+template <typename S, typename T>
+bool ply_fit_real (BYTE const* src, LENGTH src_stride, LENGTH count)
+{
+    S const high = std::ldexp(S(1), std::numeric_limits<T>::digits);
+    S const low = std::numeric_limits<T>::is_signed ? -high : S(0);
+    for (LENGTH i = 0; i < count; ++i)
+    {
+        S value;
+        std::memcpy(&value, src + i * src_stride, sizeof(S));
+        if (!(value >= low && value < high) || value != std::trunc(value))
+            return false;
+    }
+    return true;
+}
+
+
+template <typename S, typename T>
+ply_fit_t ply_fit_of (std::true_type)
+{
+    return &ply_fit_real<S, T>;
+}
+
+
+template <typename S, typename T>
+ply_fit_t ply_fit_of (std::false_type)
+{
+    return &ply_fit_column<S, T>;
+}
+
+
+template <typename S>
+ply_fit_t ply_fitter (FLAG dest_type)
+{
+    switch (dest_type)
+    {
+        case PLYREADER_PROPERY_TYPE_VAR32:
+            return ply_fit_of<S, VAR32>(std::is_floating_point<S>());
+        case PLYREADER_PROPERY_TYPE_VAR64:
+            return ply_fit_of<S, VAR64>(std::is_floating_point<S>());
+        case PLYREADER_PROPERY_TYPE_BYTE:
+            return ply_fit_of<S, BYTE>(std::is_floating_point<S>());
+        case PLYREADER_PROPERY_TYPE_WORD:
+            return ply_fit_of<S, WORD>(std::is_floating_point<S>());
+        case PLYREADER_PROPERY_TYPE_CHAR:
+            return ply_fit_of<S, CHAR>(std::is_floating_point<S>());
+        case PLYREADER_PROPERY_TYPE_DATA:
+            return ply_fit_of<S, DATA>(std::is_floating_point<S>());
+        default:
+            return NULL;
+    }
+}
+
+
+// checks that values survive a conversion to an integer type; NULL when dest_type is real
+inline ply_fit_t ply_fitter (FLAG src_type, FLAG dest_type)
+{
+    switch (src_type)
+    {
+        case PLYREADER_PROPERY_TYPE_VAL32:
+            return ply_fitter<VAL32>(dest_type);
+        case PLYREADER_PROPERY_TYPE_VAL64:
+            return ply_fitter<VAL64>(dest_type);
+        case PLYREADER_PROPERY_TYPE_VAR32:
+            return ply_fitter<VAR32>(dest_type);
+        case PLYREADER_PROPERY_TYPE_VAR64:
+            return ply_fitter<VAR64>(dest_type);
+        case PLYREADER_PROPERY_TYPE_BYTE:
+            return ply_fitter<BYTE>(dest_type);
+        case PLYREADER_PROPERY_TYPE_WORD:
+            return ply_fitter<WORD>(dest_type);
+        case PLYREADER_PROPERY_TYPE_CHAR:
+            return ply_fitter<CHAR>(dest_type);
+        case PLYREADER_PROPERY_TYPE_DATA:
+            return ply_fitter<DATA>(dest_type);
+        default:
+            return NULL;
+    }
+}
+
+using ply_scatter_t = void (*) (BYTE const* src, BYTE* dest, LENGTH dest_stride, LENGTH count);
+
+
+template <int N>
+void ply_scatter_column (BYTE const* src, BYTE* dest, LENGTH dest_stride, LENGTH count)
+{
+    for (LENGTH i = 0; i < count; ++i)
+        std::memcpy(dest + i * dest_stride, src + i * N, N);
+}
+
+
+inline ply_scatter_t ply_scatterer (LENGTH width)
+{
+    switch (width)
+    {
+        case 1:
+            return &ply_scatter_column<1>;
+        case 2:
+            return &ply_scatter_column<2>;
+        case 4:
+            return &ply_scatter_column<4>;
+        case 8:
+            return &ply_scatter_column<8>;
+        default:
+            throw std::invalid_argument("Invalid property width");
+    }
+}
+
+
+using ply_format_t = char* (*) (BYTE const* src, char* dest);
+
+
+template <typename T>
+char* ply_format_native (BYTE const* src, char* dest)
+{
+    T value;
+    std::memcpy(&value, src, sizeof(T));
+    return util::formatter::format_number(dest, value);
+}
+
+
+inline ply_format_t ply_formatter (FLAG type)
+{
+    switch (type)
+    {
+        case PLYREADER_PROPERY_TYPE_VAL32:
+            return &ply_format_native<VAL32>;
+        case PLYREADER_PROPERY_TYPE_VAL64:
+            return &ply_format_native<VAL64>;
+        case PLYREADER_PROPERY_TYPE_VAR32:
+            return &ply_format_native<VAR32>;
+        case PLYREADER_PROPERY_TYPE_VAR64:
+            return &ply_format_native<VAR64>;
+        case PLYREADER_PROPERY_TYPE_BYTE:
+            return &ply_format_native<BYTE>;
+        case PLYREADER_PROPERY_TYPE_WORD:
+            return &ply_format_native<WORD>;
+        case PLYREADER_PROPERY_TYPE_CHAR:
+            return &ply_format_native<CHAR>;
+        case PLYREADER_PROPERY_TYPE_DATA:
+            return &ply_format_native<DATA>;
+        default:
+            throw std::invalid_argument("Invalid property type");
+    }
+}
+
+
+inline char const* ply_type_name (FLAG type)
+{
+    switch (type)
+    {
+        case PLYREADER_PROPERY_TYPE_VAL32:
+            return "float";
+        case PLYREADER_PROPERY_TYPE_VAL64:
+            return "double";
+        case PLYREADER_PROPERY_TYPE_VAR32:
+            return "int";
+        case PLYREADER_PROPERY_TYPE_VAR64:
+            return "int64";
+        case PLYREADER_PROPERY_TYPE_BYTE:
+            return "uchar";
+        case PLYREADER_PROPERY_TYPE_WORD:
+            return "uint16";
+        case PLYREADER_PROPERY_TYPE_CHAR:
+            return "uint32";
+        case PLYREADER_PROPERY_TYPE_DATA:
+            return "uint64";
+        default:
+            throw std::invalid_argument("Invalid property type");
+    }
+}
+
+inline void ply_color_convert (float const* src, unsigned char* dest, int num = 3)
+{
+    for (int c = 0; c < num; ++c)
+    {
+        float color = src[c];
+        color = color * 255.0f;
+        color = std::min(255.0f, std::max(0.0f, color));
+        dest[c] = (unsigned char)(color + 0.5f);
+    }
+}
@@ -2,9 +2,9 @@
 #include "PlyReader.h"
 #include <string>
 #include <fstream>
-#include <deque>
 #include <list>
 #include <map>
+#include <algorithm>
 #include <cstring>
 #include <cerrno>
 #include <stdexcept>
@@ -14,116 +14,343 @@
 #include "tokenizer.h"
 #include "strings.h"
 #include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
 #include "system.h"
+#include "parser.h"
+#include "PlyCodec.h"
 
 using namespace std;
 
-static constexpr auto PLYREADER_PROPERY_TYPE_NULL = FLAG (0X00) ;
-static constexpr auto PLYREADER_PROPERY_TYPE_VAL32 = FLAG (0X10) ;
-static constexpr auto PLYREADER_PROPERY_TYPE_VAL64 = FLAG (0X11) ;
-static constexpr auto PLYREADER_PROPERY_TYPE_VAR32 = FLAG (0X20) ;
-static constexpr auto PLYREADER_PROPERY_TYPE_VAR64 = FLAG (0X21) ;
-static constexpr auto PLYREADER_PROPERY_TYPE_BYTE = FLAG (0X30) ;
-static constexpr auto PLYREADER_PROPERY_TYPE_WORD = FLAG (0X31) ;
-static constexpr auto PLYREADER_PROPERY_TYPE_CHAR = FLAG (0X32) ;
-static constexpr auto PLYREADER_PROPERY_TYPE_DATA = FLAG (0X33) ;
-
 static constexpr auto PLYREADER_BODY_TYPE_VALUE = FLAG (0X10) ;
 static constexpr auto PLYREADER_BODY_TYPE_INDEX = FLAG (0X11) ;
 static constexpr auto PLYREADER_BODY_TYPE_BYTE = FLAG (0X12) ;
+static constexpr auto PLYREADER_BODY_TYPE_LIST = FLAG (0X0100) ;
 static constexpr auto PLYREADER_BODY_TYPE_VALUE_LIST = FLAG (0X0110) ;
 static constexpr auto PLYREADER_BODY_TYPE_INDEX_LIST = FLAG (0X0111) ;
 static constexpr auto PLYREADER_BODY_TYPE_BYTE_LIST = FLAG (0X0112) ;
 
-enum PLYFormat
-{
-    PLY_ASCII,
-    PLY_BINARY_LE,
-    PLY_BINARY_BE,
-    PLY_UNKNOWN
-};
+static constexpr auto PLYREADER_OPERATION_VALUE = FLAG (0X01) ;
+static constexpr auto PLYREADER_OPERATION_LIST = FLAG (0X02) ;
+static constexpr auto PLYREADER_OPERATION_SKIP = FLAG (0X03) ;
+static constexpr auto PLYREADER_OPERATION_SKIP_LIST = FLAG (0X04) ;
 
-template <typename T>
-T ply_read_value (std::istream& input, PLYFormat format)
-{
-    T value;
-    switch (format)
-    {
-        case PLY_ASCII:
-            input >> value;
-            return value;
-
-        case PLY_BINARY_LE:
-            input.read(reinterpret_cast<char*>(&value), sizeof(T));
-            return util::system::letoh(value);
-
-        case PLY_BINARY_BE:
-            input.read(reinterpret_cast<char*>(&value), sizeof(T));
-            return util::system::betoh(value);
-
-        default:
-            throw std::invalid_argument("Invalid data format");
-    }
-}
+namespace SOLUTION {
 
+static constexpr auto PLYREADER_BLOCK_SIZE = LENGTH (1 << 20) ;
+static constexpr auto PLYREADER_BLOCK_ROWS = LENGTH (4096) ;
 
-template <>
-unsigned char ply_read_value<unsigned char> (std::istream& input, PLYFormat format)
-{
-    switch (format)
-    {
-        case PLY_ASCII:
-        {
-            int temp;
-            input >> temp;
-            return static_cast<unsigned char>(temp);
-        }
-
-        case PLY_BINARY_LE:
-        case PLY_BINARY_BE:
-        {
-            unsigned char value;
-            input.read(reinterpret_cast<char*>(&value), 1);
-            return value;
-        }
-
-        default:
-            throw std::invalid_argument("Invalid data format");
-    }
-}
+// reads fixed-size chunks of a stream on a background thread, keeping up to depth chunks
+// ahead of the consumer so that disk reads overlap with decoding
+class BlockPrefetch {
+private:
+	std::istream *mStream ;
+	LENGTH mSize ;
+	LENGTH mDepth ;
+	std::deque<vector<BYTE>> mReady ;
+	vector<vector<BYTE>> mFree ;
+	vector<BYTE> mChunk ;
+	LENGTH mChunkPos ;
+	BOOL mFinish ;
+	BOOL mStop ;
+	std::mutex mMutex ;
+	std::condition_variable mCondition ;
+	std::thread mThread ;
 
+public:
+	BlockPrefetch () = delete ;
+	BlockPrefetch (const BlockPrefetch &) = delete ;
+	BlockPrefetch &operator= (const BlockPrefetch &) = delete ;
+
+	explicit BlockPrefetch (std::istream &stream ,const LENGTH &size ,const LENGTH &depth) {
+		mStream = &stream ;
+		mSize = size ;
+		mDepth = depth ;
+		mChunkPos = 0 ;
+		mFinish = false ;
+		mStop = false ;
+		mThread = std::thread ([this] {
+			produce () ;
+		}) ;
+	}
 
-template <>
-char ply_read_value<char> (std::istream& input, PLYFormat format);
+	~BlockPrefetch () {
+		{
+			std::lock_guard<std::mutex> r1x (mMutex) ;
+			mStop = true ;
+		}
+		mCondition.notify_all () ;
+		mThread.join () ;
+	}
 
-template
-float ply_read_value<float> (std::istream& input, PLYFormat format);
+	// copies up to size bytes in stream order and returns fewer only at the end of the stream
+	LENGTH read (BYTE *dest ,const LENGTH &size) {
+		LENGTH ret = 0 ;
+		while (ret < size)
+		{
+			if (mChunkPos == LENGTH (mChunk.size ()))
+			{
+				std::unique_lock<std::mutex> r1x (mMutex) ;
+				mCondition.wait (r1x ,[this] {
+					return !mReady.empty () || mFinish ;
+				}) ;
+				if (mReady.empty ())
+					break ;
+				mFree.push_back (std::move (mChunk)) ;
+				mChunk = std::move (mReady.front ()) ;
+				mReady.pop_front () ;
+				mChunkPos = 0 ;
+				r1x.unlock () ;
+				mCondition.notify_all () ;
+				continue ;
+			}
+			const auto r2x = std::min (size - ret ,LENGTH (mChunk.size ()) - mChunkPos) ;
+			std::memcpy (dest + ret ,mChunk.data () + mChunkPos ,r2x) ;
+			mChunkPos += r2x ;
+			ret += r2x ;
+		}
+		return ret ;
+	}
 
-template
-double ply_read_value<double> (std::istream& input, PLYFormat format);
+private:
+	void produce () {
+		while (true)
+		{
+			vector<BYTE> r1x ;
+			{
+				std::unique_lock<std::mutex> r2x (mMutex) ;
+				mCondition.wait (r2x ,[this] {
+					return mStop || LENGTH (mReady.size ()) < mDepth ;
+				}) ;
+				if (mStop)
+					return ;
+				if (!mFree.empty ())
+				{
+					r1x = std::move (mFree.back ()) ;
+					mFree.pop_back () ;
+				}
+			}
+			r1x.resize (mSize) ;
+			mStream->read (reinterpret_cast<char *> (r1x.data ()) ,mSize) ;
+			const auto r3x = LENGTH (mStream->gcount ()) ;
+			r1x.resize (r3x) ;
+			{
+				std::lock_guard<std::mutex> r4x (mMutex) ;
+				mReady.push_back (std::move (r1x)) ;
+				mFinish = r3x < mSize ;
+			}
+			mCondition.notify_all () ;
+			if (r3x < mSize)
+				return ;
+		}
+	}
+} ;
+
+class BlockReader {
+private:
+	std::istream *mStream ;
+	std::unique_ptr<BlockPrefetch> mPrefetch ;
+	vector<BYTE> mBuffer ;
+	const BYTE *mPos ;
+	const BYTE *mEnd ;
+	LENGTH mCapacity ;
+	LENGTH mOffset ;
+
+public:
+	BlockReader () = delete ;
+
+	explicit BlockReader (std::istream &stream ,const LENGTH &capacity ,const LENGTH &depth = 0) {
+		mStream = &stream ;
+		if (depth > 0)
+			mPrefetch.reset (new BlockPrefetch (stream ,capacity ,depth)) ;
+		mBuffer.resize (capacity) ;
+		mPos = mBuffer.data () ;
+		mEnd = mPos ;
+		mCapacity = capacity ;
+		mOffset = 0 ;
+	}
+
+	explicit BlockReader (const BYTE *begin ,const BYTE *end ,const LENGTH &capacity) {
+		mStream = NULL ;
+		mPos = begin ;
+		mEnd = end ;
+		mCapacity = capacity ;
+		mOffset = 0 ;
+	}
 
+	BOOL mapped () const {
+		return mStream == NULL ;
+	}
+
+	LENGTH capacity () const {
+		return mCapacity ;
+	}
 
-template
-unsigned int ply_read_value<unsigned int> (std::istream& input, PLYFormat format);
+	const BYTE *position () const {
+		return mPos ;
+	}
+
+	LENGTH offset () const {
+		return mOffset ;
+	}
 
+	const BYTE *require (const LENGTH &size) {
+		if (fetch (size) < size)
+			throw util::Exception ("Unexpected end of PLY body") ;
+		return mPos ;
+	}
 
-template
-int ply_read_value<int> (std::istream& input, PLYFormat format);
+	LENGTH fetch (const LENGTH &size) {
+		if (LENGTH (mEnd - mPos) < size)
+			refill (size) ;
+		return LENGTH (mEnd - mPos) ;
+	}
 
+	void advance (const LENGTH &size) {
+		mPos += size ;
+		mOffset += size ;
+	}
 
-void ply_color_convert (float const* src, unsigned char* dest, int num = 3)
-{
-    for (int c = 0; c < num; ++c)
-    {
-        float color = src[c];
-        color = color * 255.0f;
-        color = std::min(255.0f, std::max(0.0f, color));
-        dest[c] = (unsigned char)(color + 0.5f);
-    }
+private:
+	void refill (const LENGTH &size) {
+		if (mStream == NULL)
+			return ;
+		const auto r1x = LENGTH (mEnd - mPos) ;
+		if (size > LENGTH (mBuffer.size ()))
+		{
+			vector<BYTE> r2x (size) ;
+			std::memcpy (r2x.data () ,mPos ,r1x) ;
+			mBuffer.swap (r2x) ;
+		}
+		else
+		{
+			std::memmove (mBuffer.data () ,mPos ,r1x) ;
+		}
+		const auto r3x = mBuffer.data () + r1x ;
+		const auto r4x = LENGTH (mBuffer.size ()) - r1x ;
+		LENGTH r5x = 0 ;
+		if (mPrefetch != nullptr)
+		{
+			r5x = mPrefetch->read (r3x ,r4x) ;
+		}
+		else
+		{
+			mStream->read (reinterpret_cast<char *> (r3x) ,r4x) ;
+			r5x = LENGTH (mStream->gcount ()) ;
+		}
+		mPos = mBuffer.data () ;
+		mEnd = mPos + r1x + r5x ;
+	}
+} ;
+
+static constexpr auto PLYREADER_TOKEN_SIZE = LENGTH (256) ;
+
+template <class ARG1>
+BOOL ply_parse_value (const char *&pos ,const char *end ,ARG1 &value) {
+	const auto r1x = util::parser::skip_whitespaces (pos ,end) ;
+	const auto r2x = util::parser::parse_number (r1x ,end ,&value) ;
+	if (r2x == NULL || (r2x < end && !util::parser::is_whitespace (*r2x)))
+		return false ;
+	pos = r2x ;
+	return true ;
 }
 
+template <class ARG1>
+BOOL ply_parse_native (const char *&pos ,const char *end ,BYTE *dest) {
+	ARG1 r1x ;
+	if (!ply_parse_value (pos ,end ,r1x))
+		return false ;
+	std::memcpy (dest ,&r1x ,sizeof (ARG1)) ;
+	return true ;
+}
 
-namespace SOLUTION {
+using ply_parse_t = BOOL (*) (const char *&pos ,const char *end ,BYTE *dest) ;
+
+inline ply_parse_t ply_parser (const FLAG &type) {
+	switch (type)
+	{
+		case PLYREADER_PROPERY_TYPE_VAL32:
+			return &ply_parse_native<VAL32> ;
+		case PLYREADER_PROPERY_TYPE_VAL64:
+			return &ply_parse_native<VAL64> ;
+		case PLYREADER_PROPERY_TYPE_VAR32:
+			return &ply_parse_native<VAR32> ;
+		case PLYREADER_PROPERY_TYPE_VAR64:
+			return &ply_parse_native<VAR64> ;
+		case PLYREADER_PROPERY_TYPE_BYTE:
+			return &ply_parse_native<BYTE> ;
+		case PLYREADER_PROPERY_TYPE_WORD:
+			return &ply_parse_native<WORD> ;
+		case PLYREADER_PROPERY_TYPE_CHAR:
+			return &ply_parse_native<CHAR> ;
+		case PLYREADER_PROPERY_TYPE_DATA:
+			return &ply_parse_native<DATA> ;
+		default:
+			throw std::invalid_argument ("Invalid property type") ;
+	}
+}
+
+inline BOOL ply_skip_token (const char *&pos ,const char *end) {
+	const auto r1x = util::parser::skip_whitespaces (pos ,end) ;
+	auto r2x = r1x ;
+	while (r2x < end && !util::parser::is_whitespace (*r2x))
+		++r2x ;
+	if (r2x == r1x)
+		return false ;
+	pos = r2x ;
+	return true ;
+}
+
+// positions the reader on the next token and returns the bytes available for it
+inline const char *ply_next_token (BlockReader &reader ,LENGTH &size) {
+	while (true)
+	{
+		size = reader.fetch (PLYREADER_TOKEN_SIZE) ;
+		if (size == 0)
+			throw util::Exception ("Unexpected end of PLY body") ;
+		const auto r1x = reinterpret_cast<const char *> (reader.position ()) ;
+		const auto r2x = util::parser::skip_whitespaces (r1x ,r1x + size) ;
+		reader.advance (r2x - r1x) ;
+		if (r2x < r1x + size)
+			break ;
+	}
+	size = reader.fetch (PLYREADER_TOKEN_SIZE) ;
+	return reinterpret_cast<const char *> (reader.position ()) ;
+}
+
+template <class ARG1>
+ARG1 ply_parse_value (BlockReader &reader) {
+	LENGTH r1x ;
+	const auto r2x = ply_next_token (reader ,r1x) ;
+	auto r3x = r2x ;
+	ARG1 ret ;
+	if (!ply_parse_value (r3x ,r2x + r1x ,ret))
+		throw util::Exception ("Invalid PLY ASCII value") ;
+	reader.advance (r3x - r2x) ;
+	return ret ;
+}
+
+inline void ply_parse_cell (BlockReader &reader ,const ply_parse_t &parse ,BYTE *dest) {
+	LENGTH r1x ;
+	const auto r2x = ply_next_token (reader ,r1x) ;
+	auto r3x = r2x ;
+	if (!parse (r3x ,r2x + r1x ,dest))
+		throw util::Exception ("Invalid PLY ASCII value") ;
+	reader.advance (r3x - r2x) ;
+}
+
+inline void ply_skip_token (BlockReader &reader) {
+	LENGTH r1x ;
+	const auto r2x = ply_next_token (reader ,r1x) ;
+	auto r3x = r2x ;
+	ply_skip_token (r3x ,r2x + r1x) ;
+	if (r3x == r2x + r1x && r1x >= PLYREADER_TOKEN_SIZE)
+		throw util::Exception ("Invalid PLY ASCII value") ;
+	reader.advance (r3x - r2x) ;
+}
 	
 class PlyReader::Implement :public Abstract {
 private:
@@ -131,57 +358,102 @@ private:
 		std::string mName ;
 		FLAG mType ;
 		FLAG mListType ;
+		LENGTH mOffset ;
+		BOOL mSelected ;
 	} ;
 
 	struct ELEMENT {
 		string mName ;
 		LENGTH mSize ;
+		LENGTH mStride ;
 		vector<PROPERTY> mPropertyList ;
 		map<string ,INDEX> mPropertyMappingSet ;
 	} ;
 
 	struct HEADER {
 		string mFormat ;
+		vector<string> mCommentList ;
 		vector<ELEMENT> mElementList ;
 		map<string ,INDEX> mElementMappingSet ;
 		LENGTH mBodyOffset ;
 	} ;
 
+	struct STORAGE {
+		FLAG mBodyType ;
+		FLAG mType ;
+		LENGTH mWidth ;
+		const BYTE *mAddress ;
+		LENGTH mStride ;
+		vector<BYTE> mData ;
+		vector<LENGTH> mOffset ;
+	} ;
+
+	// one step of a row with its reader and destination resolved from the header once
+	struct OPERATION {
+		FLAG mCode ;
+		INDEX mProperty ;
+		LENGTH mWidth ;
+		LENGTH mRepeat ;
+		LENGTH mCountWidth ;
+		ply_decode_t mDecode ;
+		ply_count_t mCount ;
+		ply_swap_t mSwap ;
+		ply_parse_t mParse ;
+		STORAGE *mStorage ;
+	} ;
+
 private:
+	my_string_t mFile ;
 	std::ifstream mPlyFile ;
+	util::system::MappedFile mMapping ;
 	HEADER mHeader ;
 	PLYFormat mBitwiseReverseFlag ;
-	vector<vector<vector<INDEX>>> mBody ;
-	vector<vector<FLAG>> mBodyType ;
-	deque<my_value_t> mPlyValue ;
-	deque<vector<my_value_t>> mPlyValueList ;
-	deque<my_index_t> mPlyIndex ;
-	deque<vector<my_index_t>> mPlyIndexList ;
-	deque<my_byte_t> mPlyByte ;
-	deque<vector<my_byte_t>> mPlyByteList ;
+	LENGTH mThreadCount ;
+	BOOL mLazy ;
+	LENGTH mBufferSize ;
+	LENGTH mPrefetchDepth ;
+	vector<vector<STORAGE>> mBody ;
+	vector<LENGTH> mElementOffset ;
+	mutable vector<std::atomic<BOOL>> mElementLoaded ;
+	mutable std::mutex mMutex ;
+	INDEX mStreamElement ;
+	INDEX mStreamLine ;
+	LENGTH mStreamSize ;
+	vector<INDEX> mStreamProperty ;
+	std::unique_ptr<BlockReader> mStreamReader ;
 
 public:
 	Implement () = delete ;
 
-	explicit Implement (const my_string_t &file) {
+	explicit Implement (const my_string_t &file ,const OPTION &option) {
 		if (file.empty())
 		{
 			throw std::invalid_argument("No filename given");
 		}
+		mFile = file ;
 		mPlyFile.open(file.c_str(), std::ios::binary);
 		if (!mPlyFile.good()) 
 		{
 			throw util::FileException(file, std::strerror(errno));
 		}
 	
+		mThreadCount = option.mThreadCount ;
+		if (mThreadCount <= 0)
+			mThreadCount = std::max (LENGTH (1) ,LENGTH (std::thread::hardware_concurrency ())) ;
+		mLazy = option.mLazy ;
+		mBufferSize = std::max (option.mBufferSize ,LENGTH (PLYREADER_TOKEN_SIZE)) ;
+		mPrefetchDepth = option.mPrefetchDepth ;
+
 		read_header () ;
+		select_property (option.mProjection) ;
 		auto fax = true ;
 		
 		if (fax) 
 		{
 			if (mHeader.mFormat == "ascii") 
 			{
-				read_body_text () ;
+				mBitwiseReverseFlag = PLY_ASCII ;
+				read_body (file ,option) ;
 				fax = false ;
 			}
 		}
@@ -190,7 +462,7 @@ public:
 			if (mHeader.mFormat == "binary_big_endian") 
 			{
 				mBitwiseReverseFlag = PLY_BINARY_BE ;
-				read_body_binary () ;
+				read_body (file ,option) ;
 				fax = false;
 			}	
 		}
@@ -199,7 +471,7 @@ public:
 			if (mHeader.mFormat == "binary_little_endian")
 			{
 				mBitwiseReverseFlag = PLY_BINARY_LE ;
-				read_body_binary () ;
+				read_body (file ,option) ;
 				fax = false;
 			}
 		}
@@ -210,7 +482,47 @@ public:
 			
 		}
 
-		mPlyFile.close ();
+		if (!mLazy)
+			mPlyFile.close ();
+	}
+
+	// a lazy stream over the file of source with its own file handle or mapping, decode buffers
+	// and property selection; it takes the parsed header and the element offsets found so far,
+	// so source is neither parsed again nor changed by streaming
+	explicit Implement (const Implement &source) {
+		mFile = source.mFile ;
+		mPlyFile.open (mFile.c_str () ,std::ios::binary) ;
+		if (!mPlyFile.good ())
+			throw util::FileException (mFile ,std::strerror (errno)) ;
+		if (source.mMapping.data () != NULL)
+			mMapping.open (mFile) ;
+
+		mHeader = source.mHeader ;
+		mBitwiseReverseFlag = source.mBitwiseReverseFlag ;
+		mThreadCount = source.mThreadCount ;
+		mLazy = true ;
+		mBufferSize = source.mBufferSize ;
+		mPrefetchDepth = source.mPrefetchDepth ;
+		mBody = vector<vector<STORAGE>> (mHeader.mElementList.size ()) ;
+		{
+			std::lock_guard<std::mutex> r1x (source.mMutex) ;
+			mElementOffset = source.mElementOffset ;
+		}
+		mElementLoaded = vector<std::atomic<BOOL>> (mHeader.mElementList.size ()) ;
+		for (auto &&i : mElementLoaded)
+			i = false ;
+	}
+
+	vector<my_string_t> comment_list () const override {
+		return mHeader.mCommentList ;
+	}
+
+	my_index_t element_count () const override {
+		return my_index_t (mHeader.mElementList.size ()) ;
+	}
+
+	my_string_t element_name (const my_index_t &element_index) const override {
+		return mHeader.mElementList[element_index].mName ;
 	}
 
 	my_index_t find_element (const my_string_t &name) const override {
@@ -227,6 +539,14 @@ public:
 		return  mHeader.mElementList[element_index].mSize ;
 	}
 
+	my_index_t property_count (const my_index_t &element_index) const override {
+		return my_index_t (mHeader.mElementList[element_index].mPropertyList.size ()) ;
+	}
+
+	my_string_t property_name (const my_index_t &element_index ,const my_index_t &property_index) const override {
+		return mHeader.mElementList[element_index].mPropertyList[property_index].mName ;
+	}
+
 	my_index_t find_property (const my_index_t &element_index ,const my_string_t &name) const override {
 		my_index_t ret = -1 ;
 		const auto r1x = mHeader.mElementList[element_index].mPropertyMappingSet.find (name) ;
@@ -237,34 +557,156 @@ public:
 		return ret ;
 	}
 
-	const my_value_t &get_value (const my_index_t &element_index ,const my_index_t &line_index ,const my_index_t &property_index) const override {
-		assert (mBodyType[element_index][property_index] == PLYREADER_BODY_TYPE_VALUE) ;
-		return mPlyValue[mBody[element_index][line_index][property_index]] ;
+	FLAG property_type (const my_index_t &element_index ,const my_index_t &property_index) const override {
+		return mHeader.mElementList[element_index].mPropertyList[property_index].mType ;
+	}
+
+	FLAG property_list_type (const my_index_t &element_index ,const my_index_t &property_index) const override {
+		return mHeader.mElementList[element_index].mPropertyList[property_index].mListType ;
 	}
 
-	const vector<my_value_t> &get_value_list (const my_index_t &element_index ,const my_index_t &line_index ,const my_index_t &property_index) const override {
-		assert (mBodyType[element_index][property_index] == PLYREADER_BODY_TYPE_VALUE_LIST) ;
-		return mPlyValueList[mBody[element_index][line_index][property_index]] ;
+	my_value_t get_value (const my_index_t &element_index ,const my_index_t &line_index ,const my_index_t &property_index) const override {
+		const auto &r1x = storage_of (element_index ,property_index) ;
+		assert (r1x.mBodyType == PLYREADER_BODY_TYPE_VALUE) ;
+		return ply_load_scalar<my_value_t> (r1x.mAddress + line_index * r1x.mStride ,r1x.mType) ;
 	}
 
-	const my_index_t &get_index (const my_index_t &element_index ,const my_index_t &line_index ,const my_index_t &property_index) const override {
-		assert (mBodyType[element_index][property_index] == PLYREADER_BODY_TYPE_INDEX) ;
-		return mPlyIndex[mBody[element_index][line_index][property_index]] ;
+	vector<my_value_t> get_value_list (const my_index_t &element_index ,const my_index_t &line_index ,const my_index_t &property_index) const override {
+		const auto &r1x = storage_of (element_index ,property_index) ;
+		assert (r1x.mBodyType == PLYREADER_BODY_TYPE_VALUE_LIST) ;
+		return load_list<my_value_t> (r1x ,line_index) ;
 	}
 
-	const vector<my_index_t> &get_index_list (const my_index_t &element_index ,const my_index_t &line_index ,const my_index_t &property_index) const override {
-		assert (mBodyType[element_index][property_index] == PLYREADER_BODY_TYPE_INDEX_LIST) ;
-		return mPlyIndexList[mBody[element_index][line_index][property_index]] ;
+	my_index_t get_index (const my_index_t &element_index ,const my_index_t &line_index ,const my_index_t &property_index) const override {
+		const auto &r1x = storage_of (element_index ,property_index) ;
+		assert (r1x.mBodyType == PLYREADER_BODY_TYPE_INDEX) ;
+		return ply_load_scalar<my_index_t> (r1x.mAddress + line_index * r1x.mStride ,r1x.mType) ;
 	}
 
-	const my_byte_t &get_byte (const my_index_t &element_index ,const my_index_t &line_index ,const my_index_t &property_index) const override {
-		assert (mBodyType[element_index][property_index] == PLYREADER_BODY_TYPE_BYTE) ;
-		return mPlyByte[mBody[element_index][line_index][property_index]] ;
+	vector<my_index_t> get_index_list (const my_index_t &element_index ,const my_index_t &line_index ,const my_index_t &property_index) const override {
+		const auto &r1x = storage_of (element_index ,property_index) ;
+		assert (r1x.mBodyType == PLYREADER_BODY_TYPE_INDEX_LIST) ;
+		return load_list<my_index_t> (r1x ,line_index) ;
 	}
 
-	const vector<my_byte_t> &get_byte_list (const my_index_t &element_index ,const my_index_t &line_index ,const my_index_t &property_index) const override {
-		assert (mBodyType[element_index][property_index] == PLYREADER_BODY_TYPE_BYTE_LIST) ;
-		return mPlyByteList[mBody[element_index][line_index][property_index]] ;
+	my_byte_t get_byte (const my_index_t &element_index ,const my_index_t &line_index ,const my_index_t &property_index) const override {
+		const auto &r1x = storage_of (element_index ,property_index) ;
+		assert (r1x.mBodyType == PLYREADER_BODY_TYPE_BYTE) ;
+		return ply_load_scalar<my_byte_t> (r1x.mAddress + line_index * r1x.mStride ,r1x.mType) ;
+	}
+
+	vector<my_byte_t> get_byte_list (const my_index_t &element_index ,const my_index_t &line_index ,const my_index_t &property_index) const override {
+		const auto &r1x = storage_of (element_index ,property_index) ;
+		assert (r1x.mBodyType == PLYREADER_BODY_TYPE_BYTE_LIST) ;
+		return load_list<my_byte_t> (r1x ,line_index) ;
+	}
+
+	COLUMN get_column (const my_index_t &element_index ,const my_index_t &property_index) const override {
+		const auto &r1x = storage_of (element_index ,property_index) ;
+		assert ((r1x.mBodyType & PLYREADER_BODY_TYPE_LIST) == 0) ;
+		COLUMN ret ;
+		ret.mAddress = r1x.mAddress ;
+		ret.mSize = mHeader.mElementList[element_index].mSize ;
+		ret.mStride = r1x.mStride ;
+		ret.mType = r1x.mType ;
+		return ret ;
+	}
+
+	const BYTE *get_address (const my_index_t &element_index ,const my_index_t &line_index ,const my_index_t &property_index) const override {
+		const auto &r1x = storage_of (element_index ,property_index) ;
+		assert ((r1x.mBodyType & PLYREADER_BODY_TYPE_LIST) == 0) ;
+		return r1x.mAddress + line_index * r1x.mStride ;
+	}
+
+	LIST get_list (const my_index_t &element_index ,const my_index_t &line_index ,const my_index_t &property_index) const override {
+		const auto &r1x = storage_of (element_index ,property_index) ;
+		assert ((r1x.mBodyType & PLYREADER_BODY_TYPE_LIST) != 0) ;
+		LIST ret ;
+		ret.mAddress = r1x.mData.data () + r1x.mOffset[line_index] * r1x.mWidth ;
+		ret.mSize = r1x.mOffset[line_index + 1] - r1x.mOffset[line_index] ;
+		ret.mType = r1x.mType ;
+		return ret ;
+	}
+
+	// positions a stream on the first row of the element; only the listed properties, or all
+	// selected ones when the list is empty, are decoded by read_batch
+	void open_stream (const INDEX &element_index ,const vector<my_string_t> &property) {
+		auto &r1x = mHeader.mElementList[element_index] ;
+		mStreamProperty.clear () ;
+		for (INDEX j = 0 ; j < (INDEX)r1x.mPropertyList.size () && property.empty () ; ++j)
+		{
+			if (r1x.mPropertyList[j].mSelected)
+				mStreamProperty.push_back (j) ;
+		}
+		for (auto &&i : property)
+		{
+			const auto r2x = find_property (element_index ,i) ;
+			if (r2x == -1)
+				throw std::invalid_argument ("Unknown property: " + i) ;
+			mStreamProperty.push_back (r2x) ;
+		}
+		for (auto &&i : r1x.mPropertyList)
+			i.mSelected = false ;
+		for (auto &&i : mStreamProperty)
+			r1x.mPropertyList[i].mSelected = true ;
+
+		mStreamElement = element_index ;
+		mStreamLine = 0 ;
+		mStreamSize = r1x.mSize ;
+		mStreamReader.reset () ;
+		mStreamReader = open_body (locate_element (element_index)) ;
+	}
+
+	LENGTH stream_size () const {
+		return mStreamSize ;
+	}
+
+	INDEX stream_line () const {
+		return mStreamLine ;
+	}
+
+	// decodes up to size following rows into the reused element buffers and points batch at them
+	LENGTH read_batch (const LENGTH &size ,BATCH &batch) {
+		auto &r1x = mHeader.mElementList[mStreamElement] ;
+		const auto r2x = std::max (LENGTH (0) ,std::min (size ,mStreamSize - mStreamLine)) ;
+		batch.mLine = mStreamLine ;
+		batch.mSize = r2x ;
+		batch.mColumn.resize (mStreamProperty.size ()) ;
+		batch.mOffset.resize (mStreamProperty.size ()) ;
+		if (r2x == 0)
+		{
+			// the end of a fully streamed element is where the next one starts
+			if (mElementOffset[mStreamElement + 1] < 0)
+				mElementOffset[mStreamElement + 1] = mElementOffset[mStreamElement] + mStreamReader->offset () ;
+			return 0 ;
+		}
+
+		r1x.mSize = r2x ;
+		read_rows (mStreamElement ,*mStreamReader) ;
+		r1x.mSize = mStreamSize ;
+
+		for (INDEX i = 0 ; i < (INDEX)mStreamProperty.size () ; ++i)
+		{
+			const auto &r3x = mBody[mStreamElement][mStreamProperty[i]] ;
+			auto &r4x = batch.mColumn[i] ;
+			r4x.mType = r3x.mType ;
+			if ((r3x.mBodyType & PLYREADER_BODY_TYPE_LIST) == 0)
+			{
+				r4x.mAddress = r3x.mAddress ;
+				r4x.mSize = r2x ;
+				r4x.mStride = r3x.mStride ;
+				batch.mOffset[i] = NULL ;
+			}
+			else
+			{
+				r4x.mAddress = r3x.mData.data () ;
+				r4x.mSize = r3x.mOffset[r2x] ;
+				r4x.mStride = r3x.mWidth ;
+				batch.mOffset[i] = r3x.mOffset.data () ;
+			}
+		}
+		mStreamLine += r2x ;
+		return r2x ;
 	}
 
 private:
@@ -325,6 +767,7 @@ private:
 			else if (header[0] == "comment") 
 			{
 				std::cout << "PLY Loader: " << buffer << std::endl;
+				mHeader.mCommentList.push_back (buffer.size () > 8 ? buffer.substr (8) : string ()) ;
 			}
 			else if (header[0] == "element")
 			{
@@ -333,7 +776,6 @@ private:
 				mTempelement.mName = header[1];
 				auto r3x = util::strings::convert<LENGTH>(header[2]);
 				mTempelement.mSize = r3x;
-				mTempelement.mPropertyList.reserve (r3x);
 				// mTempelement.mPropertyMappingSet ;
 				mHeader.mElementList.push_back (mTempelement);
 			}
@@ -408,9 +850,15 @@ private:
 
 		for (auto &&i : mHeader.mElementList) {
 			// i.mPropertyMappingSet.(i.mPropertyList.size ()) ;
+			i.mStride = 0 ;
 			for (int j = 0 ; j < (int) i.mPropertyList.size () ; ++j)
 			{
 				i.mPropertyMappingSet.insert (pair < string ,int64_t > (i.mPropertyList[j].mName ,j)) ;
+				i.mPropertyList[j].mOffset = i.mStride ;
+				if (i.mStride == -1 || i.mPropertyList[j].mListType != PLYREADER_PROPERY_TYPE_NULL)
+					i.mStride = -1 ;
+				else
+					i.mStride += ply_type_width (i.mPropertyList[j].mType) ;
 			}
 		}
 		
@@ -424,460 +872,655 @@ private:
 			}
 				
 		}
-	}
 
-	void read_body_text () {
+		mHeader.mBodyOffset = LENGTH (mPlyFile.tellg ()) ;
+	}
 
-		mBody = vector<vector<vector<INDEX>>> (mHeader.mElementList.size ()) ;
-		mBodyType = vector<vector<FLAG>> (mHeader.mElementList.size ()) ;
+	// properties left out of a non-empty projection are skipped while decoding and hidden
+	// from find_property; an element listed without names keeps all of its properties
+	void select_property (const map<string ,vector<string>> &projection) {
+		for (auto &&i : mHeader.mElementList)
+		{
+			const auto r1x = projection.find (i.mName) ;
+			for (auto &&j : i.mPropertyList)
+				j.mSelected = projection.empty () || (r1x != projection.end () && r1x->second.empty ()) ;
+			if (r1x == projection.end ())
+				continue ;
+			for (auto &&j : r1x->second)
+			{
+				const auto r2x = i.mPropertyMappingSet.find (j) ;
+				if (r2x != i.mPropertyMappingSet.end ())
+					i.mPropertyList[r2x->second].mSelected = true ;
+			}
+		}
 
-		for (INDEX i = 0 ; i < (INDEX)mHeader.mElementList.size () ; ++i)
+		for (auto &&i : mHeader.mElementList)
 		{
-			mBody[i] = vector<vector<INDEX>> (mHeader.mElementList[i].mSize) ;
-			mBodyType[i] = vector<FLAG> (mHeader.mElementList[i].mPropertyList.size ()) ;
-			for (INDEX k = 0 ; i < (INDEX)mHeader.mElementList[i].mSize ; ++k) 
+			for (auto &&j : i.mPropertyList)
 			{
-				mBody[i][k] = vector<INDEX> (mHeader.mElementList[i].mPropertyList.size ()) ;
-				for (INDEX j = 0 ; j < (INDEX) mHeader.mElementList[i].mPropertyList.size () ; ++j)
-				{
-					const auto r3x = mHeader.mElementList[i].mPropertyList[j].mType ;
-					const auto r4x = mHeader.mElementList[i].mPropertyList[j].mListType ;
-					
-					if (true) 
-					{
-						
-						if (r3x == PLYREADER_PROPERY_TYPE_VAL32) 
-						{
-							INDEX ix = (INDEX) mPlyValue.size () ;
-							
-							const auto r5x = ply_read_value<float>(mPlyFile, PLY_ASCII);
+				if (!j.mSelected)
+					i.mPropertyMappingSet.erase (j.mName) ;
+			}
+		}
+	}
 
-							mPlyValue.push_back (my_value_t (r5x)) ;
-							mBodyType[i][j] = PLYREADER_BODY_TYPE_VALUE ;
-							mBody[i][k][j] = ix ;
-						}
+	// elements are decoded by load_element, here or on first access in lazy mode
+	void read_body (const my_string_t &file ,const OPTION &option) {
+		if (option.mMapping)
+			mMapping.open (file) ;
+
+		const auto r1x = mHeader.mElementList.size () ;
+		mBody = vector<vector<STORAGE>> (r1x) ;
+		mElementOffset.assign (r1x + 1 ,-1) ;
+		mElementOffset[0] = 0 ;
+		mElementLoaded = vector<std::atomic<BOOL>> (r1x) ;
+		for (auto &&i : mElementLoaded)
+			i = false ;
+
+		if (mLazy)
+			return ;
+		for (INDEX i = 0 ; i < (INDEX)r1x ; ++i)
+		{
+			if (element_selected (i))
+				load_element (i) ;
+		}
+	}
 
-						else if (r3x == PLYREADER_PROPERY_TYPE_VAL64) 
-						{
-							INDEX ix = (INDEX) mPlyValue.size ();
-							const auto r6x = ply_read_value<double>(mPlyFile, PLY_ASCII);
-							mPlyValue.push_back (my_value_t(r6x)) ;
-							mBodyType[i][j] = PLYREADER_BODY_TYPE_VALUE ;
-							mBody[i][k][j] = ix ;
-						}
+	BOOL element_selected (const INDEX &element_index) const {
+		for (auto &&i : mHeader.mElementList[element_index].mPropertyList)
+		{
+			if (i.mSelected)
+				return true ;
+		}
+		return false ;
+	}
 
-						else if (r3x == PLYREADER_PROPERY_TYPE_VAR32)
-						{
-							INDEX ix = (INDEX) mPlyIndex.size ();
-							const auto r7x = ply_read_value<int32_t>(mPlyFile, PLY_ASCII);
-							mPlyIndex.push_back (my_index_t (r7x)) ;
-							mBodyType[i][j] = PLYREADER_BODY_TYPE_INDEX ;
-							mBody[i][k][j] = ix ;
-						}
+	const STORAGE &storage_of (const INDEX &element_index ,const INDEX &property_index) const {
+		load_element (element_index) ;
+		return mBody[element_index][property_index] ;
+	}
 
-						else if (r3x == PLYREADER_PROPERY_TYPE_VAR64) 
-						{
-							INDEX ix = (INDEX) mPlyIndex.size() ;
-							const auto r8x = ply_read_value<int64_t>(mPlyFile, PLY_ASCII);
-							mPlyIndex.push_back (my_index_t (r8x)) ;
-							mBodyType[i][j] = PLYREADER_BODY_TYPE_INDEX ;
-							mBody[i][k][j] = ix ;
-						}
+	void load_element (const INDEX &element_index) const {
+		if (mElementLoaded[element_index])
+			return ;
+		std::lock_guard<std::mutex> r1x (mMutex) ;
+		if (mElementLoaded[element_index])
+			return ;
+		const_cast<Implement *> (this)->read_element (element_index) ;
+		mElementLoaded[element_index] = true ;
+	}
 
-						else if (r3x == PLYREADER_PROPERY_TYPE_BYTE) 
-						{
-							INDEX ix = (INDEX) mPlyByte.size ();
-							const auto r9x = ply_read_value<int64_t>(mPlyFile, PLY_ASCII);
-							assert (r9x >= 0);
-							mPlyByte.push_back (my_byte_t (r9x)) ;
-							mBodyType[i][j] = PLYREADER_BODY_TYPE_BYTE ;
-							mBody[i][k][j] = ix ;
-						}
+	// elements before the requested one that are not decoded yet are passed over: fixed-stride
+	// binary elements by their record size, list elements by their list sizes only and ASCII
+	// elements token by token
+	LENGTH locate_element (const INDEX &element_index) {
+		INDEX ix = element_index ;
+		while (mElementOffset[ix] < 0)
+			--ix ;
+		for (; ix < element_index ; ++ix)
+		{
+			if (mElementOffset[ix + 1] >= 0)
+				continue ;
+			const auto &r1x = mHeader.mElementList[ix] ;
+			if (mBitwiseReverseFlag != PLY_ASCII && r1x.mStride >= 0)
+			{
+				mElementOffset[ix + 1] = mElementOffset[ix] + r1x.mSize * r1x.mStride ;
+				continue ;
+			}
+			access_body (mElementOffset[ix] ,[&] (BlockReader &reader) {
+				skip_element (ix ,reader) ;
+				mElementOffset[ix + 1] = mElementOffset[ix] + reader.offset () ;
+			}) ;
+		}
+		return mElementOffset[element_index] ;
+	}
 
-						else if (r3x == PLYREADER_PROPERY_TYPE_WORD)
-						{
-							INDEX ix = (INDEX) mPlyByte.size () ;
-							const auto r10x = ply_read_value<int64_t>(mPlyFile, PLY_ASCII);
-							assert (r10x >= 0) ;
-							mPlyByte.push_back (my_byte_t (r10x)) ;
-							mBodyType[i][j] = PLYREADER_BODY_TYPE_BYTE ;
-							mBody[i][k][j] = ix ;
-						}
+	template <class ARG1>
+	void access_body (const LENGTH &offset ,const ARG1 &func) {
+		const auto r1x = open_body (offset) ;
+		func (*r1x) ;
+	}
 
-						else if (r3x == PLYREADER_PROPERY_TYPE_CHAR) 
-						{							
-							INDEX ix = (INDEX) mPlyByte.size () ;
-							const auto r11x = ply_read_value<int64_t>(mPlyFile, PLY_ASCII);
-							assert (r11x >= 0) ;
-							mPlyByte.push_back(my_byte_t (r11x));
-							mBodyType[i][j] = PLYREADER_BODY_TYPE_BYTE ;
-							mBody[i][k][j] = ix ;
-						}
+	std::unique_ptr<BlockReader> open_body (const LENGTH &offset) {
+		const auto r1x = mHeader.mBodyOffset + offset ;
 
-						else if (r3x == PLYREADER_PROPERY_TYPE_DATA)
-						{
-							INDEX ix = (INDEX) mPlyByte.size () ;
-							const auto r12x = ply_read_value<int64_t>(mPlyFile, PLY_ASCII);
-							assert (r12x >= 0) ;
-							mPlyByte.push_back (my_byte_t (r12x)) ;
-							mBodyType[i][j] = PLYREADER_BODY_TYPE_BYTE ;
-							mBody[i][k][j] = ix ;
-						}
+		if (mMapping.data () != NULL)
+		{
+			const auto r2x = reinterpret_cast<const BYTE *> (mMapping.data ()) ;
+			return std::unique_ptr<BlockReader> (new BlockReader (r2x + std::min (r1x ,LENGTH (mMapping.size ())) ,r2x + mMapping.size () ,mBufferSize)) ;
+		}
+		mPlyFile.clear () ;
+		mPlyFile.seekg (r1x) ;
+		return std::unique_ptr<BlockReader> (new BlockReader (mPlyFile ,mBufferSize ,mPrefetchDepth)) ;
+	}
 
-						else {}
-					}
+	void read_element (const INDEX &element_index) {
+		access_body (locate_element (element_index) ,[&] (BlockReader &reader) {
+			read_element (element_index ,reader) ;
+		}) ;
+	}
 
-					if (r4x != PLYREADER_PROPERY_TYPE_NULL) 
-					{
-						LENGTH r13x = -1 ; 
-						{
-							if (mBodyType[i][j] == PLYREADER_BODY_TYPE_VALUE)
-								r13x =  LENGTH (mPlyValue[mBody[i][k][j]]) ;
-							if (mBodyType[i][j] == PLYREADER_BODY_TYPE_INDEX)
-								r13x =  LENGTH (mPlyIndex[mBody[i][k][j]]) ;
-							if (mBodyType[i][j] == PLYREADER_BODY_TYPE_BYTE)
-								r13x = LENGTH (mPlyByte[mBody[i][k][j]]) ;
-						}
-						assert (r13x != -1) ;
+	void skip_element (const INDEX &element_index ,BlockReader &reader) {
+		const auto &r1x = mHeader.mElementList[element_index] ;
 
-						if (r4x == PLYREADER_PROPERY_TYPE_VAL32) 
-						{
-							INDEX ix = (INDEX) mPlyValueList.size ();
-							mPlyValueList.push_back (vector<my_value_t> (r13x)) ;
-							mBodyType[i][j] = PLYREADER_BODY_TYPE_VALUE_LIST ;
-							mBody[i][k][j] = ix ;
-
-							for (INDEX t = 0 ; t < (INDEX) mPlyValueList[ix].size() ; ++t)
-							{
-								const auto r14x = ply_read_value<float>(mPlyFile, PLY_ASCII);
-								mPlyValueList[ix][t] = my_value_t (r14x) ;
-							}
-						}
+		const auto r7x = compile_plan (element_index ,false) ;
 
-						else if (r4x == PLYREADER_PROPERY_TYPE_VAL64)
-						{
-							INDEX ix = (INDEX)mPlyValueList.size () ;
-							mPlyValueList.push_back(vector<my_value_t> (r13x)) ;
-							mBodyType[i][j] = PLYREADER_BODY_TYPE_VALUE_LIST ;
-							mBody[i][k][j] = ix ;
-
-							for (INDEX t = 0 ; t < (INDEX) mPlyValueList[ix].size () ; ++t) {
-								const auto r15x = ply_read_value<double>(mPlyFile, PLY_ASCII); ;
-								mPlyValueList[ix][t] = my_value_t (r15x) ;
-							}
-						}
+		if (mBitwiseReverseFlag == PLY_ASCII)
+		{
+			for (INDEX k = 0 ; k < r1x.mSize ; ++k)
+			{
+				for (auto &&i : r7x)
+					read_cell_text (i ,k ,reader) ;
+			}
+			return ;
+		}
 
-						else if (r4x == PLYREADER_PROPERY_TYPE_VAR32)
-						{
-							INDEX ix = (INDEX) mPlyIndexList.size () ;
-							mPlyIndexList.push_back (vector<my_index_t> (r13x)) ;
-							mBodyType[i][j] = PLYREADER_BODY_TYPE_INDEX_LIST ;
-							mBody[i][k][j] = ix ;
-
-							for (INDEX t = 0 ; t < (INDEX)mPlyIndexList[ix].size () ; ++t) {
-								const auto r16x = ply_read_value<int32_t>(mPlyFile, PLY_ASCII);
-								mPlyIndexList[ix][t] = my_index_t (r16x) ;
-							}
-						}
+		vector<LENGTH> r2x ;
+		INDEX k = 0 ;
+		while (k < r1x.mSize)
+		{
+			auto r3x = mBufferSize ;
+			INDEX r4x = 0 ;
+			LENGTH r5x = 0 ;
+			while (true)
+			{
+				const auto r6x = reader.fetch (r3x) ;
+				r5x = scan_rows (element_index ,r7x ,k ,reader.position () ,r6x ,r2x ,r4x) ;
+				if (r4x > 0)
+					break ;
+				if (r6x < r3x)
+					throw util::Exception ("Unexpected end of PLY body") ;
+				r3x *= 2 ;
+			}
+			reader.advance (r5x) ;
+			k += r4x ;
+		}
+	}
 
-						else if (r4x == PLYREADER_PROPERY_TYPE_VAR64)
-						{
-							INDEX ix = (INDEX) mPlyIndexList.size () ;
-							mPlyIndexList.push_back (vector<my_index_t> (r13x)) ;
-							mBodyType[i][j] = PLYREADER_BODY_TYPE_INDEX_LIST ;
-							mBody[i][k][j] = ix ;
-
-							for (INDEX t = 0 ; t < (INDEX)mPlyIndexList[ix].size () ; ++t) {
-								const auto r17x = ply_read_value<int64_t>(mPlyFile, PLY_ASCII);
-								mPlyIndexList[ix][t] = my_index_t (r17x) ;
-							}
-						}
+	void read_element (const INDEX &element_index ,BlockReader &reader) {
+		read_rows (element_index ,reader) ;
+		mElementOffset[element_index + 1] = mElementOffset[element_index] + reader.offset () ;
+	}
 
-						else if (r4x == PLYREADER_PROPERY_TYPE_BYTE)
-						{
-							INDEX ix = (INDEX) mPlyByteList.size () ;
-							mPlyByteList.push_back (vector<my_byte_t> (r13x)) ;
-							mBodyType[i][j] = PLYREADER_BODY_TYPE_BYTE_LIST ;
-							mBody[i][k][j] = ix ;
-
-							for (INDEX t = 0 ; t < (INDEX)mPlyByteList[ix].size () ; ++t) {
-								const auto r18x = ply_read_value<int64_t>(mPlyFile, PLY_ASCII);
-								assert (r18x >= 0) ;
-								mPlyByteList[ix][t] = my_byte_t (r18x) ;
-							}
-						}
+	// decodes mSize rows of the element from the reader's position into mBody
+	void read_rows (const INDEX &element_index ,BlockReader &reader) {
+		if (mBitwiseReverseFlag == PLY_ASCII)
+		{
+			reserve_element (element_index) ;
+			const auto r1x = compile_plan (element_index ,true) ;
+			if (mThreadCount > 1)
+				read_element_text_parallel (element_index ,r1x ,reader) ;
+			else
+				read_element_text (element_index ,r1x ,0 ,reader) ;
+		}
+		else if (mHeader.mElementList[element_index].mStride >= 0)
+		{
+			read_element_fixed (element_index ,reader) ;
+		}
+		else
+		{
+			read_element_variable (element_index ,reader) ;
+		}
+	}
 
-						else if (r4x == PLYREADER_PROPERY_TYPE_WORD)
-						{
-							INDEX ix = (INDEX) mPlyByteList.size () ;
-							mPlyByteList.push_back (vector<my_byte_t> (r13x)) ;
-							mBodyType[i][j] = PLYREADER_BODY_TYPE_BYTE_LIST ;
-							mBody[i][k][j] = ix ;
-
-							for (INDEX t = 0 ; t < (INDEX)mPlyByteList[ix].size() ; ++t) {
-								const auto r19x = ply_read_value<int64_t>(mPlyFile, PLY_ASCII);
-								assert (r19x >= 0) ;
-								mPlyByteList[ix][t] = my_byte_t (r19x) ;
-							}
-						}
+	void read_element_text (const INDEX &element_index ,const vector<OPERATION> &plan ,const INDEX &line ,BlockReader &reader) {
+		const auto &r1x = mHeader.mElementList[element_index] ;
 
-						else if (r4x == PLYREADER_PROPERY_TYPE_CHAR)
-						{
-							INDEX ix = (INDEX) mPlyByteList.size () ;
-							mPlyByteList.push_back (vector<my_byte_t> (r13x)) ;
-							mBodyType[i][j] = PLYREADER_BODY_TYPE_BYTE_LIST ;
-							mBody[i][k][j] = ix ;
-
-							for (INDEX t = 0 ; t < (INDEX)mPlyByteList[ix].size() ; ++t) {
-								const auto r20x = ply_read_value<int64_t>(mPlyFile, PLY_ASCII);
-								assert (r20x >= 0) ;
-								mPlyByteList[ix][t] = my_byte_t (r20x) ;
-							}
-						}
+		for (INDEX k = line ; k < r1x.mSize ; ++k) 
+		{
+			for (auto &&i : plan)
+				read_cell_text (i ,k ,reader) ;
+		}
+	}
 
-						else if (r4x == PLYREADER_PROPERY_TYPE_DATA)
-						{
-							INDEX ix = (INDEX) mPlyByteList.size () ;
-							mPlyByteList.push_back (vector<my_byte_t> (r13x)) ;
-							mBodyType[i][j] = PLYREADER_BODY_TYPE_BYTE_LIST ;
-							mBody[i][k][j] = ix ;
-
-							for (INDEX t = 0 ; t < (INDEX)mPlyByteList[ix].size () ; ++t) {
-								const auto r21x = ply_read_value<int64_t>(mPlyFile, PLY_ASCII);
-								assert (r21x >= 0) ;
-								mPlyByteList[ix][t] = my_byte_t (r21x) ;
-							}
-						}
+	// splits windows of whole lines into row ranges parsed concurrently, one row per line.
+	// a window holding a row that spans several lines is re-parsed serially from its start.
+	void read_element_text_parallel (const INDEX &element_index ,const vector<OPERATION> &plan ,BlockReader &reader) {
+		const auto &r1x = mHeader.mElementList[element_index] ;
+		const auto r2x = mBufferSize * 4 * mThreadCount ;
+		vector<LENGTH> r3x ;
+		INDEX k = 0 ;
+
+		while (k < r1x.mSize)
+		{
+			auto r4x = r2x ;
+			LENGTH r5x = 0 ;
+			LENGTH r6x = 0 ;
+			const char *r7x = NULL ;
+			r3x.clear () ;
 
-						else {}
+			while (r3x.empty ())
+			{
+				r5x = std::min (reader.fetch (r4x) ,r4x) ;
+				if (r5x == 0)
+					throw util::Exception ("Unexpected end of PLY body") ;
+				r7x = reinterpret_cast<const char *> (reader.position ()) ;
+				r6x = 0 ;
+				while (r6x < r5x && k + LENGTH (r3x.size () / 2) < r1x.mSize)
+				{
+					const auto r8x = static_cast<const char *> (std::memchr (r7x + r6x ,'\n' ,r5x - r6x)) ;
+					if (r8x == NULL && r5x >= r4x)
+						break ;
+					const auto r9x = r8x == NULL ? r5x : LENGTH (r8x - r7x) ;
+					if (util::parser::skip_whitespaces (r7x + r6x ,r7x + r9x) < r7x + r9x)
+					{
+						r3x.push_back (r6x) ;
+						r3x.push_back (r9x) ;
 					}
+					r6x = std::min (r5x ,r9x + 1) ;
+				}
+				if (r3x.empty () && r6x > 0)
+				{
+					reader.advance (r6x) ;
+					continue ;
+				}
+				r4x *= 2 ;
+			}
+
+			// list values of each row range go to a private buffer and are appended in row order
+			const auto r10x = LENGTH (r3x.size () / 2) ;
+			std::atomic<BOOL> r11x (true) ;
+			std::mutex r12x ;
+			vector<pair<LENGTH ,vector<vector<BYTE>>>> r13x ;
+			util::system::parallel_for (r10x ,mThreadCount ,[&] (std::size_t begin ,std::size_t end) {
+				vector<vector<BYTE>> r14x (r1x.mPropertyList.size ()) ;
+				for (auto t = begin ; t < end && r11x ; ++t)
+				{
+					if (!parse_row_text (plan ,k + t ,r7x + r3x[2 * t] ,r7x + r3x[2 * t + 1] ,r14x))
+						r11x = false ;
 				}
+				std::lock_guard<std::mutex> r15x (r12x) ;
+				r13x.emplace_back (LENGTH (begin) ,std::move (r14x)) ;
+			}) ;
+
+			if (!r11x)
+			{
+				read_element_text (element_index ,plan ,k ,reader) ;
+				return ;
 			}
+			if (r1x.mStride < 0)
+				append_list_text (plan ,k ,r10x ,r13x) ;
+			reader.advance (r6x) ;
+			k += r10x ;
 		}
 	}
 
-	void read_body_binary () {
+	// parses one row; list sizes are left in the offset table and list values appended to list
+	BOOL parse_row_text (const vector<OPERATION> &plan ,const INDEX &line ,const char *pos ,const char *end ,vector<vector<BYTE>> &list) {
+		for (auto &&i : plan)
+		{
+			if (i.mCode == PLYREADER_OPERATION_VALUE)
+			{
+				if (!i.mParse (pos ,end ,&i.mStorage->mData[line * i.mWidth]))
+					return false ;
+				continue ;
+			}
+			auto r1x = i.mRepeat ;
+			if (i.mCode != PLYREADER_OPERATION_SKIP)
+			{
+				if (!ply_parse_value (pos ,end ,r1x) || r1x < 0)
+					return false ;
+			}
+			if (i.mCode != PLYREADER_OPERATION_LIST)
+			{
+				for (INDEX t = 0 ; t < r1x ; ++t)
+				{
+					if (!ply_skip_token (pos ,end))
+						return false ;
+				}
+				continue ;
+			}
+			auto &r2x = list[i.mProperty] ;
+			const auto r3x = LENGTH (r2x.size ()) ;
+			r2x.resize (r3x + r1x * i.mWidth) ;
+			for (INDEX t = 0 ; t < r1x ; ++t)
+			{
+				if (!i.mParse (pos ,end ,&r2x[r3x + t * i.mWidth]))
+					return false ;
+			}
+			i.mStorage->mOffset[line + 1] = r1x ;
+		}
+		return util::parser::skip_whitespaces (pos ,end) == end ;
+	}
 
-		mBody = vector<vector<vector<INDEX>>> (mHeader.mElementList.size ()) ;
-		mBodyType = vector<vector<FLAG>> (mHeader.mElementList.size ()) ;
+	void append_list_text (const vector<OPERATION> &plan ,const INDEX &line ,const LENGTH &size ,vector<pair<LENGTH ,vector<vector<BYTE>>>> &list) {
+		std::sort (list.begin () ,list.end () ,[] (const pair<LENGTH ,vector<vector<BYTE>>> &a ,const pair<LENGTH ,vector<vector<BYTE>>> &b) {
+			return a.first < b.first ;
+		}) ;
 
-		for (INDEX i = 0 ; i < (INDEX)mHeader.mElementList.size () ; ++i) 
+		for (auto &&i : plan)
 		{
-			mBody[i] = vector<vector<INDEX>> (mHeader.mElementList[i].mSize) ;
-			mBodyType[i] = vector<FLAG> (mHeader.mElementList[i].mPropertyList.size ()) ;
+			if (i.mCode != PLYREADER_OPERATION_LIST)
+				continue ;
+			auto &r1x = *i.mStorage ;
+			for (INDEX k = line ; k < line + size ; ++k)
+				r1x.mOffset[k + 1] += r1x.mOffset[k] ;
+			for (auto &&j : list)
+				r1x.mData.insert (r1x.mData.end () ,j.second[i.mProperty].begin () ,j.second[i.mProperty].end ()) ;
+		}
+	}
 
-			for (INDEX k = 0 ; k < (INDEX)mHeader.mElementList[i].mSize ; ++k) 
-			{
-				mBody[i][k] = vector<INDEX> (mHeader.mElementList[i].mPropertyList.size ()) ;
+	void read_element_fixed (const INDEX &element_index ,BlockReader &reader) {
+		const auto &r1x = mHeader.mElementList[element_index] ;
 
-				for (INDEX j = 0 ; j < (INDEX)mHeader.mElementList[i].mPropertyList.size () ; ++j) 
-				{
-					const auto r2x = mHeader.mElementList[i].mPropertyList[j].mType ;
-					const auto r3x = mHeader.mElementList[i].mPropertyList[j].mListType ;
+		if (reader.mapped () && mBitwiseReverseFlag == PLY_BINARY_HOST)
+		{
+			map_element (element_index ,reader.require (r1x.mSize * r1x.mStride)) ;
+			reader.advance (r1x.mSize * r1x.mStride) ;
+			return ;
+		}
 
-					if (true)
-					{
-						if (r2x == PLYREADER_PROPERY_TYPE_VAL32)
-						{
-							INDEX ix = (INDEX) mPlyValue.size () ;
-							const auto r5x = ply_read_value<VAL32>(mPlyFile, mBitwiseReverseFlag);
-							mPlyValue.push_back (my_value_t (r5x)) ;
-							mBodyType[i][j] = PLYREADER_BODY_TYPE_VALUE ;
-							mBody[i][k][j] = ix ;
-						}
+		reserve_element (element_index) ;
+		if (r1x.mStride == 0)
+			return ;
 
-						else if (r2x == PLYREADER_PROPERY_TYPE_VAL64) 
-						{
-							INDEX ix = (INDEX) mPlyValue.size () ;
-							const auto r7x = ply_read_value<VAL64>(mPlyFile, mBitwiseReverseFlag);
-							mPlyValue.push_back (my_value_t (r7x)) ;
-							mBodyType[i][j] = PLYREADER_BODY_TYPE_VALUE ;
-							mBody[i][k][j] = ix ;
-						}
-				
-						else if (r2x == PLYREADER_PROPERY_TYPE_VAR32)
-						{
-							INDEX ix = (INDEX) mPlyIndex.size () ;
-							const auto r9x = ply_read_value<VAR32>(mPlyFile, mBitwiseReverseFlag); ;
-							mPlyIndex.push_back (my_index_t (r9x)) ;
-							mBodyType[i][j] = PLYREADER_BODY_TYPE_INDEX ;
-							mBody[i][k][j] = ix ;
-						}
+		vector<ply_gather_t> r2x (r1x.mPropertyList.size () ,NULL) ;
+		for (INDEX j = 0 ; j < (INDEX)r1x.mPropertyList.size () ; ++j)
+		{
+			if (!r1x.mPropertyList[j].mSelected)
+				continue ;
+			const auto r3x = ply_type_width (r1x.mPropertyList[j].mType) ;
+			r2x[j] = mBitwiseReverseFlag == PLY_BINARY_HOST ? ply_gatherer<false> (r3x) : ply_gatherer<true> (r3x) ;
+		}
 
-						else if (r2x == PLYREADER_PROPERY_TYPE_VAR64)
-						{
-							INDEX ix = (INDEX) mPlyIndex.size () ;
-							const auto r11x = ply_read_value<VAR64>(mPlyFile, mBitwiseReverseFlag);
-							mPlyIndex.push_back (my_index_t (r11x)) ;
-							mBodyType[i][j] = PLYREADER_BODY_TYPE_INDEX ;
-							mBody[i][k][j] = ix ;
-						}
+		// every worker owns a disjoint row range of the block, so no synchronization is needed
+		const auto r4x = std::max (LENGTH (1) ,reader.capacity () * mThreadCount / r1x.mStride) ;
+		for (INDEX k = 0 ; k < r1x.mSize ; k += r4x)
+		{
+			const auto r5x = std::min (r4x ,r1x.mSize - k) ;
+			const auto r6x = reader.require (r5x * r1x.mStride) ;
+			const auto r7x = r5x * r1x.mStride < PLYREADER_BLOCK_SIZE ? LENGTH (1) : mThreadCount ;
+			util::system::parallel_for (r5x ,r7x ,[&] (std::size_t begin ,std::size_t end) {
+				gather_rows (element_index ,r2x ,r6x ,k ,INDEX (begin) ,INDEX (end)) ;
+			}) ;
+			reader.advance (r5x * r1x.mStride) ;
+		}
+	}
 
-						else if (r2x == PLYREADER_PROPERY_TYPE_BYTE)
-						{
-							INDEX ix = (INDEX) mPlyByte.size () ;
-							const auto r13x = ply_read_value<BYTE>(mPlyFile, mBitwiseReverseFlag);
-							mPlyByte.push_back (my_byte_t (r13x)) ;
-							mBodyType[i][j] = PLYREADER_BODY_TYPE_BYTE ;
-							mBody[i][k][j] = ix ;
-						}
+	void gather_rows (const INDEX &element_index ,const vector<ply_gather_t> &gather ,const BYTE *block ,const INDEX &line ,const INDEX &begin ,const INDEX &end) {
+		const auto &r1x = mHeader.mElementList[element_index] ;
 
-						else if (r2x == PLYREADER_PROPERY_TYPE_WORD)
-						{
-							INDEX ix = (INDEX)mPlyByte.size () ;
-							const auto r15x = ply_read_value<WORD>(mPlyFile, mBitwiseReverseFlag);
-							mPlyByte.push_back (my_byte_t (r15x)) ;
-							mBodyType[i][j] = PLYREADER_BODY_TYPE_BYTE ;
-							mBody[i][k][j] = ix ;
-						}
+		for (INDEX j = 0 ; j < (INDEX)r1x.mPropertyList.size () ; ++j)
+		{
+			if (gather[j] == NULL)
+				continue ;
+			auto &r2x = mBody[element_index][j] ;
+			gather[j] (block + begin * r1x.mStride + r1x.mPropertyList[j].mOffset ,r1x.mStride ,&r2x.mData[(line + begin) * r2x.mWidth] ,end - begin) ;
+		}
+	}
 
-						else if (r2x == PLYREADER_PROPERY_TYPE_CHAR)
-						{
-							INDEX ix = (INDEX) mPlyByte.size () ;
-							const auto r17x =ply_read_value<CHAR>(mPlyFile, mBitwiseReverseFlag);
-							mPlyByte.push_back (my_byte_t (r17x)) ;
-							mBodyType[i][j] = PLYREADER_BODY_TYPE_BYTE ;
-							mBody[i][k][j] = ix ;
-						}
+	// a window is scanned for list sizes first, which fixes the offset table and the start of
+	// every run of rows, then the runs are decoded concurrently into preallocated list buffers.
+	void read_element_variable (const INDEX &element_index ,BlockReader &reader) {
+		const auto &r1x = mHeader.mElementList[element_index] ;
+		reserve_element (element_index) ;
+		const auto r11x = compile_plan (element_index ,true) ;
+		vector<LENGTH> r2x ;
+		INDEX k = 0 ;
 
-						else if (r2x == PLYREADER_PROPERY_TYPE_DATA)
-						{
-							INDEX ix = (INDEX) mPlyByte.size () ;
-							const auto r19x = ply_read_value<DATA>(mPlyFile, mBitwiseReverseFlag);
-							mPlyByte.push_back (my_byte_t (r19x)) ;
-							mBodyType[i][j] = PLYREADER_BODY_TYPE_BYTE ;
-							mBody[i][k][j] = ix ;
-						}
+		while (k < r1x.mSize)
+		{
+			auto r3x = mBufferSize * 4 * mThreadCount ;
+			INDEX r4x = 0 ;
+			LENGTH r5x = 0 ;
 
-						else {}
-					}
+			while (true)
+			{
+				const auto r6x = reader.fetch (r3x) ;
+				r5x = scan_rows (element_index ,r11x ,k ,reader.position () ,r6x ,r2x ,r4x) ;
+				if (r4x > 0)
+					break ;
+				if (r6x < r3x)
+					throw util::Exception ("Unexpected end of PLY body") ;
+				r3x *= 2 ;
+			}
 
-					if (r3x != PLYREADER_PROPERY_TYPE_NULL)
-					{
-						LENGTH r20x = -1 ;
-						{
-							if (mBodyType[i][j] == PLYREADER_BODY_TYPE_VALUE)
-								r20x = LENGTH (mPlyValue[mBody[i][k][j]]) ;
-							if (mBodyType[i][j] == PLYREADER_BODY_TYPE_INDEX)
-								r20x = LENGTH (mPlyIndex[mBody[i][k][j]]) ;
-							if (mBodyType[i][j] == PLYREADER_BODY_TYPE_BYTE)
-								r20x = LENGTH (mPlyByte[mBody[i][k][j]]) ;
-						}
-						assert (r20x != -1) ;
+			for (auto &&i : r11x)
+			{
+				if (i.mCode == PLYREADER_OPERATION_LIST)
+					i.mStorage->mData.resize (i.mStorage->mOffset[k + r4x] * i.mWidth) ;
+			}
 
-						if (r3x == PLYREADER_PROPERY_TYPE_VAL32)
-						{
-							// ply_read_value<VAR64>(mPlyFile, mBitwiseReverseFlag);
-							INDEX ix = (INDEX) mPlyValueList.size () ;
-							mPlyValueList.push_back (vector<my_value_t> (r20x)) ;
-							mBodyType[i][j] = PLYREADER_BODY_TYPE_VALUE_LIST ;
-							mBody[i][k][j] = ix ;
-
-							for (INDEX t = 0 ; t < (INDEX)mPlyValueList[ix].size () ; ++t )
-							{
-								const auto r22x = ply_read_value<VAL32>(mPlyFile, mBitwiseReverseFlag);
-								mPlyValueList[ix][t] = my_value_t (r22x) ;
-							}
-						}
-						
-						else if (r3x == PLYREADER_PROPERY_TYPE_VAL64)
-						{
-							INDEX ix = (INDEX)mPlyValueList.size () ;
-							mPlyValueList.push_back (vector<my_value_t> (r20x)) ;
-							mBodyType[i][j] = PLYREADER_BODY_TYPE_VALUE_LIST ;
-							mBody[i][k][j] = ix ;
+			const auto r7x = reader.position () ;
+			const auto r8x = r5x < PLYREADER_BLOCK_SIZE ? LENGTH (1) : mThreadCount ;
+			util::system::parallel_for (r2x.size () ,r8x ,[&] (std::size_t begin ,std::size_t end) {
+				for (auto t = begin ; t < end ; ++t)
+				{
+					const auto r9x = k + INDEX (t) * PLYREADER_BLOCK_ROWS ;
+					decode_rows (r11x ,r9x ,std::min (r9x + PLYREADER_BLOCK_ROWS ,k + r4x) ,r7x + r2x[t]) ;
+				}
+			}) ;
+			reader.advance (r5x) ;
+			k += r4x ;
+		}
+	}
 
-							for (INDEX t = 0 ; t < (INDEX)mPlyValueList[ix].size () ; ++t) {
+	// walks whole rows from line reading only list sizes and returns the bytes covered by the
+	// rows counted in size; offset tables of the plan's lists are filled on the way and the
+	// byte position of every PLYREADER_BLOCK_ROWS rows is kept in start
+	LENGTH scan_rows (const INDEX &element_index ,const vector<OPERATION> &plan ,const INDEX &line ,const BYTE *block ,const LENGTH &length ,vector<LENGTH> &start ,INDEX &size) {
+		const auto &r1x = mHeader.mElementList[element_index] ;
+		LENGTH ret = 0 ;
+		start.clear () ;
+		size = 0 ;
 
-								const auto r24x = ply_read_value<VAL64>(mPlyFile, mBitwiseReverseFlag);
-								mPlyValueList[ix][t] = my_value_t (r24x) ;
-							}
-						}
+		for (INDEX k = line ; k < r1x.mSize ; ++k)
+		{
+			auto r2x = ret ;
+			for (auto &&i : plan)
+			{
+				if (r2x > length)
+					break ;
+				if (i.mCode == PLYREADER_OPERATION_VALUE || i.mCode == PLYREADER_OPERATION_SKIP)
+				{
+					r2x += i.mWidth ;
+					continue ;
+				}
+				if (r2x + i.mCountWidth > length)
+				{
+					r2x = length + 1 ;
+					break ;
+				}
+				const auto r3x = i.mCount (block + r2x) ;
+				if (r3x < 0)
+					throw util::Exception ("Invalid PLY list size") ;
+				if (i.mCode == PLYREADER_OPERATION_LIST)
+					i.mStorage->mOffset[k + 1] = i.mStorage->mOffset[k] + r3x ;
+				r2x += i.mCountWidth + r3x * i.mWidth ;
+			}
+			if (r2x > length)
+				break ;
+			if (size % PLYREADER_BLOCK_ROWS == 0)
+				start.push_back (ret) ;
+			ret = r2x ;
+			++size ;
+		}
+		return ret ;
+	}
 
-						else if (r3x == PLYREADER_PROPERY_TYPE_VAR32)
-						{
-							INDEX ix = (INDEX)mPlyIndexList.size () ;
-							mPlyIndexList.push_back (vector<my_index_t> (r20x)) ;
-							mBodyType[i][j] = PLYREADER_BODY_TYPE_INDEX_LIST ;
-							mBody[i][k][j] = ix ;
-
-							for (INDEX t = 0 ; t < (INDEX)mPlyIndexList[ix].size () ; ++t) {
-								const auto r26x = ply_read_value<VAR32>(mPlyFile, mBitwiseReverseFlag);
-								mPlyIndexList[ix][t] = my_index_t (r26x) ;
-							}
-						}
+	void decode_rows (const vector<OPERATION> &plan ,const INDEX &begin ,const INDEX &end ,const BYTE *block) {
+		for (INDEX k = begin ; k < end ; ++k)
+		{
+			for (auto &&i : plan)
+			{
+				switch (i.mCode)
+				{
+					case PLYREADER_OPERATION_VALUE:
+					{
+						i.mDecode (block ,&i.mStorage->mData[k * i.mWidth]) ;
+						block += i.mWidth ;
+						break ;
+					}
+					case PLYREADER_OPERATION_LIST:
+					{
+						block += i.mCountWidth ;
+						const auto &r1x = i.mStorage->mOffset ;
+						const auto r2x = r1x[k + 1] - r1x[k] ;
+						const auto r3x = i.mStorage->mData.data () + r1x[k] * i.mWidth ;
+						std::memcpy (r3x ,block ,r2x * i.mWidth) ;
+						if (i.mSwap != NULL)
+							i.mSwap (r3x ,r2x) ;
+						block += r2x * i.mWidth ;
+						break ;
+					}
+					case PLYREADER_OPERATION_SKIP:
+					{
+						block += i.mWidth ;
+						break ;
+					}
+					default:
+					{
+						block += i.mCountWidth + i.mCount (block) * i.mWidth ;
+						break ;
+					}
+				}
+			}
+		}
+	}
 
-						else if (r3x == PLYREADER_PROPERY_TYPE_VAR64)
-						{
-							INDEX ix = (INDEX)mPlyIndexList.size () ;
-							mPlyIndexList.push_back (vector<my_index_t> (r20x)) ;
-							mBodyType[i][j] = PLYREADER_BODY_TYPE_INDEX_LIST ;
-							mBody[i][k][j] = ix ;
-
-							for (INDEX t = 0 ; t < (INDEX) mPlyIndexList[ix].size () ; ++t) {
-								const auto r28x = ply_read_value<VAR64>(mPlyFile, mBitwiseReverseFlag);
-								mPlyIndexList[ix][t] = my_index_t (r28x) ;
-							}
-						}
+	// resolves the element into a flat plan, one operation per property with adjacent skipped
+	// scalars merged; without record every property is skipped
+	vector<OPERATION> compile_plan (const INDEX &element_index ,const BOOL &record) {
+		const auto &r1x = mHeader.mElementList[element_index] ;
+		const auto r2x = mBitwiseReverseFlag != PLY_ASCII ;
+		const auto r3x = mBitwiseReverseFlag != PLY_BINARY_HOST ;
+		vector<OPERATION> ret ;
 
-						else if (r3x == PLYREADER_PROPERY_TYPE_BYTE)
-						{
-							INDEX ix = (INDEX)mPlyByteList.size () ;
-							mPlyByteList.push_back (vector<my_byte_t> (r20x)) ;
-							mBodyType[i][j] = PLYREADER_BODY_TYPE_BYTE_LIST ;
-							mBody[i][k][j] = ix ;
-
-							for (INDEX t = 0 ; t < (INDEX)mPlyByteList[ix].size () ; ++t) {
-								const auto r30x = ply_read_value<BYTE>(mPlyFile, mBitwiseReverseFlag);
-								mPlyByteList[ix][t] = my_byte_t (r30x) ;
-							}
-						}
+		for (INDEX j = 0 ; j < (INDEX)r1x.mPropertyList.size () ; ++j)
+		{
+			const auto &r4x = r1x.mPropertyList[j] ;
+			const auto r5x = record && r4x.mSelected ;
+			OPERATION r6x = {} ;
+			r6x.mProperty = j ;
+			r6x.mStorage = r5x ? &mBody[element_index][j] : NULL ;
 
-						else if (r3x == PLYREADER_PROPERY_TYPE_WORD)
-						{
-							INDEX ix = (INDEX) mPlyByteList.size () ;
-							mPlyByteList.push_back (vector<my_byte_t> (r20x)) ;
-							mBodyType[i][j] = PLYREADER_BODY_TYPE_BYTE_LIST ;
-							mBody[i][k][j] = ix ;
-
-							for (INDEX t = 0 ; t < (INDEX)mPlyByteList[ix].size () ; ++t) {
-								const auto r32x = ply_read_value<WORD>(mPlyFile, mBitwiseReverseFlag);
-								mPlyByteList[ix][t] = my_byte_t (r32x) ;
-							}
-						}
+			if (r4x.mListType == PLYREADER_PROPERY_TYPE_NULL)
+			{
+				r6x.mWidth = ply_type_width (r4x.mType) ;
+				r6x.mRepeat = 1 ;
+				if (!r5x && !ret.empty () && ret.back ().mCode == PLYREADER_OPERATION_SKIP)
+				{
+					ret.back ().mWidth += r6x.mWidth ;
+					ret.back ().mRepeat += 1 ;
+					continue ;
+				}
+				r6x.mCode = r5x ? PLYREADER_OPERATION_VALUE : PLYREADER_OPERATION_SKIP ;
+				if (r5x)
+				{
+					r6x.mDecode = r3x ? ply_decoder<true> (r6x.mWidth) : ply_decoder<false> (r6x.mWidth) ;
+					r6x.mParse = ply_parser (r4x.mType) ;
+				}
+			}
+			else
+			{
+				r6x.mCode = r5x ? PLYREADER_OPERATION_LIST : PLYREADER_OPERATION_SKIP_LIST ;
+				r6x.mWidth = ply_type_width (r4x.mListType) ;
+				r6x.mCountWidth = ply_type_width (r4x.mType) ;
+				if (r2x)
+					r6x.mCount = r3x ? ply_counter<true> (r4x.mType) : ply_counter<false> (r4x.mType) ;
+				r6x.mSwap = r3x ? ply_swapper (r6x.mWidth) : NULL ;
+				r6x.mParse = ply_parser (r4x.mListType) ;
+			}
+			ret.push_back (r6x) ;
+		}
+		return ret ;
+	}
 
-						else if (r3x == PLYREADER_PROPERY_TYPE_CHAR)
-						{
-							INDEX ix = (INDEX)mPlyByteList.size () ;
-							mPlyByteList.push_back (vector<my_byte_t> (r20x)) ;
-							mBodyType[i][j] = PLYREADER_BODY_TYPE_BYTE_LIST ;
-							mBody[i][k][j] = ix ;
-
-							for (INDEX t = 0 ; t < (INDEX) mPlyByteList[ix].size () ; ++t) {
-								const auto r34x = ply_read_value<CHAR>(mPlyFile, mBitwiseReverseFlag);
-								mPlyByteList[ix][t] = my_byte_t (r34x) ;
-							}
-						}
+	// buffers already held by the element are reused, which keeps streamed batches allocation free
+	void reserve_element (const INDEX &element_index) {
+		const auto &r1x = mHeader.mElementList[element_index] ;
+		mBody[element_index].resize (r1x.mPropertyList.size ()) ;
 
-						else if (r3x == PLYREADER_PROPERY_TYPE_DATA)
-						{
-							INDEX ix = (INDEX)mPlyByteList.size () ;
-							mPlyByteList.push_back (vector<my_byte_t> (r20x)) ;
-							mBodyType[i][j] = PLYREADER_BODY_TYPE_BYTE_LIST ;
-							mBody[i][k][j] = ix ;
-
-							for (INDEX t = 0 ; t < (INDEX) mPlyByteList[ix].size () ; ++t) {
-								const auto r36x = ply_read_value<DATA>(mPlyFile, mBitwiseReverseFlag);
-								mPlyByteList[ix][t] = my_byte_t (r36x) ;
-							}
-						}
+		for (INDEX j = 0 ; j < (INDEX)r1x.mPropertyList.size () ; ++j)
+		{
+			auto &r2x = mBody[element_index][j] ;
+			const auto &r3x = r1x.mPropertyList[j] ;
 
-						else {}
-					}
-				}
+			if (r3x.mListType == PLYREADER_PROPERY_TYPE_NULL)
+			{
+				r2x.mBodyType = body_type_of (r3x.mType) ;
+				r2x.mType = r3x.mType ;
+				r2x.mWidth = ply_type_width (r2x.mType) ;
+				if (r3x.mSelected)
+					r2x.mData.resize (r1x.mSize * r2x.mWidth) ;
+				r2x.mAddress = r2x.mData.data () ;
+				r2x.mStride = r2x.mWidth ;
+			}
+			else
+			{
+				r2x.mBodyType = body_type_of (r3x.mListType) | PLYREADER_BODY_TYPE_LIST ;
+				r2x.mType = r3x.mListType ;
+				r2x.mWidth = ply_type_width (r2x.mType) ;
+				r2x.mAddress = NULL ;
+				r2x.mStride = 0 ;
+				r2x.mData.clear () ;
+				if (r3x.mSelected)
+					r2x.mOffset.assign (r1x.mSize + 1 ,0) ;
 			}
 		}
 	}
+
+	void map_element (const INDEX &element_index ,const BYTE *address) {
+		const auto &r1x = mHeader.mElementList[element_index] ;
+		mBody[element_index].resize (r1x.mPropertyList.size ()) ;
+
+		for (INDEX j = 0 ; j < (INDEX)r1x.mPropertyList.size () ; ++j)
+		{
+			auto &r2x = mBody[element_index][j] ;
+			const auto &r3x = r1x.mPropertyList[j] ;
+			r2x.mBodyType = body_type_of (r3x.mType) ;
+			r2x.mType = r3x.mType ;
+			r2x.mWidth = ply_type_width (r2x.mType) ;
+			r2x.mAddress = address + r3x.mOffset ;
+			r2x.mStride = r1x.mStride ;
+		}
+	}
+
+	void read_cell_text (const OPERATION &operation ,const INDEX &line ,BlockReader &reader) {
+		if (operation.mCode == PLYREADER_OPERATION_VALUE)
+		{
+			ply_parse_cell (reader ,operation.mParse ,&operation.mStorage->mData[line * operation.mWidth]) ;
+			return ;
+		}
+
+		auto r1x = operation.mRepeat ;
+		if (operation.mCode != PLYREADER_OPERATION_SKIP)
+		{
+			r1x = ply_parse_value<LENGTH> (reader) ;
+			if (r1x < 0)
+				throw util::Exception ("Invalid PLY list size") ;
+		}
+		if (operation.mCode != PLYREADER_OPERATION_LIST)
+		{
+			for (INDEX t = 0 ; t < r1x ; ++t)
+				ply_skip_token (reader) ;
+			return ;
+		}
+
+		auto &r2x = *operation.mStorage ;
+		const auto r3x = r2x.mOffset[line] ;
+		r2x.mOffset[line + 1] = r3x + r1x ;
+		r2x.mData.resize ((r3x + r1x) * r2x.mWidth) ;
+		for (INDEX t = 0 ; t < r1x ; ++t)
+			ply_parse_cell (reader ,operation.mParse ,&r2x.mData[(r3x + t) * r2x.mWidth]) ;
+	}
+
+	template <class ARG1>
+	static vector<ARG1> load_list (const STORAGE &storage ,const INDEX &line) {
+		const auto r1x = storage.mData.data () + storage.mOffset[line] * storage.mWidth ;
+		vector<ARG1> ret (storage.mOffset[line + 1] - storage.mOffset[line]) ;
+		for (INDEX t = 0 ; t < (INDEX)ret.size () ; ++t)
+			ret[t] = ply_load_scalar<ARG1> (r1x + t * storage.mWidth ,storage.mType) ;
+		return ret ;
+	}
+
+	static FLAG body_type_of (const FLAG &type) {
+		if (type == PLYREADER_PROPERY_TYPE_VAL32 || type == PLYREADER_PROPERY_TYPE_VAL64)
+			return PLYREADER_BODY_TYPE_VALUE ;
+		if (type == PLYREADER_PROPERY_TYPE_VAR32 || type == PLYREADER_PROPERY_TYPE_VAR64)
+			return PLYREADER_BODY_TYPE_INDEX ;
+		return PLYREADER_BODY_TYPE_BYTE ;
+	}
 	
 } ;
 
@@ -886,8 +1529,105 @@ void PlyReader::check_avaliable (const my_holder_t &pointer) {
 	assert (pointer != nullptr) ;
 }
 
-PlyReader::my_holder_t PlyReader::create (const my_string_t &file) {
-	return std::make_shared<Implement> (file) ;
+void PlyReader::read_into (const my_index_t &element_index ,const vector<my_string_t> &property ,void *dst ,const LENGTH &stride ,const vector<FLAG> &type) const {
+	check_avaliable (mPointer) ;
+	if (property.size () != type.size ())
+		throw std::invalid_argument ("Property and type list differ in length") ;
+
+	vector<COLUMN> r1x (property.size ()) ;
+	vector<ply_convert_t> r2x (property.size ()) ;
+	vector<LENGTH> r3x (property.size ()) ;
+	LENGTH r4x = 0 ;
+	for (INDEX i = 0 ; i < (INDEX)property.size () ; ++i)
+	{
+		const auto r5x = mPointer->find_property (element_index ,property[i]) ;
+		if (r5x == -1)
+			throw std::invalid_argument ("Unknown property: " + property[i]) ;
+		r1x[i] = mPointer->get_column (element_index ,r5x) ;
+		r2x[i] = ply_converter (r1x[i].mType ,type[i]) ;
+		r3x[i] = r4x ;
+		r4x += ply_type_width (type[i]) ;
+	}
+	if (r4x > stride)
+		throw std::invalid_argument ("Record stride too small for requested properties") ;
+
+	// convert in row blocks so the source columns and the destination stay cache resident
+	static constexpr auto r6x = LENGTH (4096) ;
+	const auto r7x = mPointer->element_size (element_index) ;
+	const auto r8x = static_cast<BYTE *> (dst) ;
+	for (INDEX k = 0 ; k < r7x ; k += r6x)
+	{
+		const auto r9x = std::min (r6x ,r7x - k) ;
+		for (INDEX i = 0 ; i < (INDEX)r1x.size () ; ++i)
+			r2x[i] (r1x[i].mAddress + k * r1x[i].mStride ,r1x[i].mStride ,r8x + k * stride + r3x[i] ,stride ,r9x) ;
+	}
+}
+
+void PlyReader::read_into (const my_index_t &element_index ,const vector<my_string_t> &property ,void *dst ,const LENGTH &stride) const {
+	check_avaliable (mPointer) ;
+	vector<FLAG> r1x (property.size ()) ;
+	for (INDEX i = 0 ; i < (INDEX)property.size () ; ++i)
+	{
+		const auto r2x = mPointer->find_property (element_index ,property[i]) ;
+		if (r2x == -1)
+			throw std::invalid_argument ("Unknown property: " + property[i]) ;
+		r1x[i] = mPointer->property_type (element_index ,r2x) ;
+	}
+	read_into (element_index ,property ,dst ,stride ,r1x) ;
+}
+
+void PlyReader::visit (const my_string_t &file ,const my_string_t &element ,const vector<my_string_t> &property ,const LENGTH &batch ,const std::function<void (const BATCH &)> &func ,const OPTION &option) {
+	CURSOR r1x (file ,element ,property ,option) ;
+	while (true)
+	{
+		const auto &r2x = r1x.next_batch (batch) ;
+		if (r2x.mSize == 0)
+			break ;
+		func (r2x) ;
+	}
+}
+
+void PlyReader::CURSOR::open (const my_string_t &file ,const my_string_t &element ,const vector<my_string_t> &property ,const OPTION &option) {
+	auto r1x = option ;
+	r1x.mLazy = true ;
+	mPointer = std::make_shared<Implement> (file ,r1x) ;
+	open_element (element ,property) ;
+}
+
+void PlyReader::CURSOR::open (const PlyReader &reader ,const my_string_t &element ,const vector<my_string_t> &property) {
+	check_avaliable (reader.mPointer) ;
+	mPointer = std::make_shared<Implement> (static_cast<const Implement &> (*reader.mPointer)) ;
+	open_element (element ,property) ;
+}
+
+void PlyReader::CURSOR::open_element (const my_string_t &element ,const vector<my_string_t> &property) {
+	assert (mPointer != nullptr) ;
+	const auto r1x = mPointer->find_element (element) ;
+	if (r1x == -1)
+		throw std::invalid_argument ("Unknown element: " + element) ;
+	mPointer->open_stream (r1x ,property) ;
+}
+
+LENGTH PlyReader::CURSOR::size () const {
+	assert (mPointer != nullptr) ;
+	return mPointer->stream_size () ;
+}
+
+INDEX PlyReader::CURSOR::line () const {
+	assert (mPointer != nullptr) ;
+	return mPointer->stream_line () ;
+}
+
+const PlyReader::BATCH &PlyReader::CURSOR::next_batch (const LENGTH &max_rows) {
+	assert (mPointer != nullptr) ;
+	if (max_rows <= 0)
+		throw std::invalid_argument ("Batch size must be positive") ;
+	mPointer->read_batch (max_rows ,mBatch) ;
+	return mBatch ;
+}
+
+PlyReader::my_holder_t PlyReader::create (const my_string_t &file ,const OPTION &option) {
+	return std::make_shared<Implement> (file ,option) ;
 }
 
 };
@@ -0,0 +1,841 @@
+
+#include "PlyWriter.h"
+#include <string>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <thread>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <stdexcept>
+#include <assert.h>
+#include "exception.h"
+#include "system.h"
+#include "formatter.h"
+#include "PlyCodec.h"
+
+using namespace std;
+
+namespace SOLUTION {
+
+// digits reserved in the header for an element count patched in by close
+static constexpr auto PLYWRITER_COUNT_WIDTH = LENGTH (20) ;
+static constexpr auto PLYWRITER_BLOCK_ROWS = LENGTH (4096) ;
+static constexpr auto PLYWRITER_BATCH_ROWS = LENGTH (1 << 16) ;
+
+// collects encoded bytes in a fixed buffer and hands them to the stream in large writes
+class BlockWriter {
+private:
+	std::ostream *mStream ;
+	vector<BYTE> mBuffer ;
+	LENGTH mSize ;
+	LENGTH mOffset ;
+
+public:
+	BlockWriter () = delete ;
+
+	explicit BlockWriter (std::ostream &stream ,const LENGTH &capacity) {
+		mStream = &stream ;
+		mBuffer.resize (capacity) ;
+		mSize = 0 ;
+		mOffset = 0 ;
+	}
+
+	// keeps everything in memory, growing past capacity instead of flushing
+	explicit BlockWriter (const LENGTH &capacity) {
+		mStream = NULL ;
+		mBuffer.resize (capacity) ;
+		mSize = 0 ;
+		mOffset = 0 ;
+	}
+
+	LENGTH capacity () const {
+		return LENGTH (mBuffer.size ()) ;
+	}
+
+	const BYTE *data () const {
+		return mBuffer.data () ;
+	}
+
+	LENGTH size () const {
+		return mSize ;
+	}
+
+	void clear () {
+		mSize = 0 ;
+		mOffset = 0 ;
+	}
+
+	LENGTH offset () const {
+		return mOffset ;
+	}
+
+	// returns room for at least size bytes, flushing or growing the buffer when needed
+	BYTE *require (const LENGTH &size) {
+		if (mSize + size > LENGTH (mBuffer.size ()))
+			flush () ;
+		if (mSize + size > LENGTH (mBuffer.size ()))
+			mBuffer.resize (std::max (mSize + size ,LENGTH (mBuffer.size ()) * 2)) ;
+		return mBuffer.data () + mSize ;
+	}
+
+	void advance (const LENGTH &size) {
+		mSize += size ;
+		mOffset += size ;
+	}
+
+	void write (const void *src ,const LENGTH &size) {
+		std::memcpy (require (size) ,src ,size) ;
+		advance (size) ;
+	}
+
+	void flush () {
+		if (mSize == 0 || mStream == NULL)
+			return ;
+		mStream->write (reinterpret_cast<const char *> (mBuffer.data ()) ,mSize) ;
+		if (!mStream->good ())
+			throw util::Exception ("Failed to write PLY body") ;
+		mSize = 0 ;
+	}
+} ;
+
+class PlyWriter::Implement {
+private:
+	struct PROPERTY {
+		std::string mName ;
+		FLAG mType ;
+		FLAG mListType ;
+		LENGTH mOffset ;
+		const BYTE *mAddress ;
+		LENGTH mStride ;
+		FLAG mSource ;
+		const LENGTH *mList ;
+	} ;
+
+	struct ELEMENT {
+		string mName ;
+		LENGTH mSize ;
+		LENGTH mStride ;
+		vector<PROPERTY> mPropertyList ;
+		map<string ,INDEX> mPropertyMappingSet ;
+	} ;
+
+	// one property of a row with its converter, swapper and formatter resolved once
+	struct OPERATION {
+		const PROPERTY *mProperty ;
+		LENGTH mWidth ;
+		LENGTH mCountWidth ;
+		ply_convert_t mConvert ;
+		ply_convert_t mCount ;
+		ply_swap_t mSwap ;
+		ply_swap_t mCountSwap ;
+		ply_scatter_t mScatter ;
+		ply_format_t mFormat ;
+		ply_format_t mCountFormat ;
+	} ;
+
+private:
+	std::string mFile ;
+	std::ofstream mPlyFile ;
+	PLYFormat mFormat ;
+	std::string mFormatName ;
+	LENGTH mBufferSize ;
+	LENGTH mThreadCount ;
+	vector<string> mComment ;
+	vector<ELEMENT> mElementList ;
+	map<string ,INDEX> mElementMappingSet ;
+	std::unique_ptr<BlockWriter> mStreamWriter ;
+	INDEX mStreamElement ;
+	vector<LENGTH> mStreamCount ;
+	vector<LENGTH> mCountOffset ;
+
+public:
+	Implement () = delete ;
+
+	explicit Implement (const my_string_t &file ,const OPTION &option) {
+		if (file.empty ())
+			throw std::invalid_argument ("No filename given") ;
+		if (option.mFormat == "ascii")
+			mFormat = PLY_ASCII ;
+		else if (option.mFormat == "binary_little_endian")
+			mFormat = PLY_BINARY_LE ;
+		else if (option.mFormat == "binary_big_endian")
+			mFormat = PLY_BINARY_BE ;
+		else
+			throw std::invalid_argument ("Invalid PLY format: " + option.mFormat) ;
+		mFormatName = option.mFormat ;
+		mBufferSize = std::max (option.mBufferSize ,LENGTH (4 * util::formatter::MAX_NUMBER_LENGTH)) ;
+		mThreadCount = option.mThreadCount ;
+		if (mThreadCount <= 0)
+			mThreadCount = std::max (LENGTH (1) ,LENGTH (std::thread::hardware_concurrency ())) ;
+
+		mStreamElement = 0 ;
+		mFile = file ;
+		mPlyFile.open (file.c_str () ,std::ios::binary) ;
+		if (!mPlyFile.good ())
+			throw util::FileException (file ,std::strerror (errno)) ;
+	}
+
+	void add_comment (const my_string_t &comment) {
+		mComment.push_back (comment) ;
+	}
+
+	my_index_t add_element (const my_string_t &name ,const LENGTH &size) {
+		if (mStreamWriter != nullptr)
+			throw std::invalid_argument ("Schema is fixed once rows are appended") ;
+		if (mElementMappingSet.count (name) != 0)
+			throw std::invalid_argument ("Duplicate element: " + name) ;
+		if (size < -1)
+			throw std::invalid_argument ("Invalid element size") ;
+		ELEMENT r1x ;
+		r1x.mName = name ;
+		r1x.mSize = size ;
+		r1x.mStride = 0 ;
+		const auto ret = my_index_t (mElementList.size ()) ;
+		mElementList.push_back (r1x) ;
+		mElementMappingSet.insert (pair<string ,INDEX> (name ,ret)) ;
+		return ret ;
+	}
+
+	my_index_t add_property (const my_index_t &element_index ,const my_string_t &name ,const FLAG &type ,const FLAG &list_type) {
+		if (mStreamWriter != nullptr)
+			throw std::invalid_argument ("Schema is fixed once rows are appended") ;
+		auto &r1x = element_of (element_index) ;
+		if (r1x.mPropertyMappingSet.count (name) != 0)
+			throw std::invalid_argument ("Duplicate property: " + name) ;
+		if (ply_type_width (type) == 0 || (list_type != PLYREADER_PROPERY_TYPE_NULL && ply_type_width (list_type) == 0))
+			throw std::invalid_argument ("Invalid property type") ;
+		if (list_type != PLYREADER_PROPERY_TYPE_NULL && (type == PLYREADER_PROPERY_TYPE_VAL32 || type == PLYREADER_PROPERY_TYPE_VAL64))
+			throw std::invalid_argument ("Invalid list size type") ;
+		PROPERTY r2x ;
+		r2x.mName = name ;
+		r2x.mType = type ;
+		r2x.mListType = list_type ;
+		r2x.mOffset = r1x.mStride ;
+		r2x.mAddress = NULL ;
+		r2x.mStride = 0 ;
+		r2x.mSource = PLYREADER_PROPERY_TYPE_NULL ;
+		r2x.mList = NULL ;
+		if (r1x.mStride == -1 || list_type != PLYREADER_PROPERY_TYPE_NULL)
+			r1x.mStride = -1 ;
+		else
+			r1x.mStride += ply_type_width (type) ;
+		const auto ret = my_index_t (r1x.mPropertyList.size ()) ;
+		r1x.mPropertyList.push_back (r2x) ;
+		r1x.mPropertyMappingSet.insert (pair<string ,INDEX> (name ,ret)) ;
+		return ret ;
+	}
+
+	void set_column (const my_index_t &element_index ,const my_index_t &property_index ,const void *src ,const LENGTH &stride ,const FLAG &type) {
+		auto &r1x = property_of (element_index ,property_index) ;
+		if (r1x.mListType != PLYREADER_PROPERY_TYPE_NULL)
+			throw std::invalid_argument ("Property is a list: " + r1x.mName) ;
+		if (ply_type_width (type) == 0)
+			throw std::invalid_argument ("Invalid property type") ;
+		r1x.mAddress = static_cast<const BYTE *> (src) ;
+		r1x.mStride = stride ;
+		r1x.mSource = type ;
+		r1x.mList = NULL ;
+	}
+
+	void set_list (const my_index_t &element_index ,const my_index_t &property_index ,const LENGTH *offset ,const void *src ,const FLAG &type) {
+		auto &r1x = property_of (element_index ,property_index) ;
+		if (r1x.mListType == PLYREADER_PROPERY_TYPE_NULL)
+			throw std::invalid_argument ("Property is not a list: " + r1x.mName) ;
+		if (ply_type_width (type) == 0)
+			throw std::invalid_argument ("Invalid property type") ;
+		r1x.mAddress = static_cast<const BYTE *> (src) ;
+		r1x.mStride = ply_type_width (type) ;
+		r1x.mSource = type ;
+		r1x.mList = offset ;
+	}
+
+	void set_record (const my_index_t &element_index ,const vector<my_string_t> &property ,const void *src ,const LENGTH &stride) {
+		const auto &r1x = element_of (element_index) ;
+		LENGTH r2x = 0 ;
+		for (auto &&i : property)
+		{
+			const auto r3x = r1x.mPropertyMappingSet.find (i) ;
+			if (r3x == r1x.mPropertyMappingSet.end ())
+				throw std::invalid_argument ("Unknown property: " + i) ;
+			const auto r4x = r1x.mPropertyList[r3x->second].mType ;
+			set_column (element_index ,r3x->second ,static_cast<const BYTE *> (src) + r2x ,stride ,r4x) ;
+			r2x += ply_type_width (r4x) ;
+		}
+		if (r2x > stride)
+			throw std::invalid_argument ("Record stride too small for requested properties") ;
+	}
+
+	void write () {
+		if (mStreamWriter != nullptr)
+			throw std::invalid_argument ("Rows were already appended, use close") ;
+		for (INDEX i = 0 ; i < (INDEX)mElementList.size () ; ++i)
+		{
+			if (mElementList[i].mSize < 0)
+				throw std::invalid_argument ("Element size unknown: " + mElementList[i].mName) ;
+			check_bound (i) ;
+		}
+
+		BlockWriter r1x (mPlyFile ,mBufferSize) ;
+		const auto r2x = header_text () ;
+		r1x.write (r2x.data () ,LENGTH (r2x.size ())) ;
+		r1x.flush () ;
+		util::system::PositionalFile r3x ;
+		if (mThreadCount > 1)
+		{
+			mPlyFile.flush () ;
+			if (!mPlyFile.good ())
+				throw util::FileException (mFile ,"Failed to write PLY header") ;
+		}
+		if (mThreadCount > 1 && r3x.open (mFile))
+		{
+			auto r4x = LENGTH (r2x.size ()) ;
+			for (INDEX i = 0 ; i < (INDEX)mElementList.size () ; ++i)
+				r4x = write_rows_parallel (i ,r4x ,r3x) ;
+			r3x.close () ;
+		}
+		else
+		{
+			for (INDEX i = 0 ; i < (INDEX)mElementList.size () ; ++i)
+				write_rows (i ,mElementList[i].mSize ,r1x) ;
+			r1x.flush () ;
+		}
+		close_file () ;
+	}
+
+	// encodes the next size rows of the element from the bound data; the header goes out with
+	// the first call and elements have to be appended in declaration order
+	void append_rows (const my_index_t &element_index ,const LENGTH &size) {
+		element_of (element_index) ;
+		if (size < 0)
+			throw std::invalid_argument ("Invalid row count") ;
+		if (mStreamWriter == nullptr)
+			open_stream () ;
+		if (element_index < mStreamElement)
+			throw std::invalid_argument ("Elements must be appended in order") ;
+		for (; mStreamElement < element_index ; ++mStreamElement)
+			check_complete (mStreamElement) ;
+		const auto &r1x = mElementList[element_index] ;
+		if (r1x.mSize >= 0 && mStreamCount[element_index] + size > r1x.mSize)
+			throw std::invalid_argument ("More rows than declared: " + r1x.mName) ;
+		if (size == 0)
+			return ;
+		check_bound (element_index) ;
+		write_rows (element_index ,size ,*mStreamWriter) ;
+		mStreamCount[element_index] += size ;
+	}
+
+	// flushes appended rows and writes the counted sizes into the reserved header fields
+	void close () {
+		if (mStreamWriter == nullptr)
+			open_stream () ;
+		for (; mStreamElement < (INDEX)mElementList.size () ; ++mStreamElement)
+			check_complete (mStreamElement) ;
+		mStreamWriter->flush () ;
+		mStreamWriter.reset () ;
+		for (INDEX i = 0 ; i < (INDEX)mElementList.size () ; ++i)
+		{
+			if (mCountOffset[i] < 0)
+				continue ;
+			const auto r1x = std::to_string (mStreamCount[i]) ;
+			mPlyFile.seekp (mCountOffset[i]) ;
+			mPlyFile.write (r1x.data () ,LENGTH (r1x.size ())) ;
+		}
+		close_file () ;
+	}
+
+private:
+	ELEMENT &element_of (const my_index_t &element_index) {
+		if (element_index < 0 || element_index >= (INDEX)mElementList.size ())
+			throw std::invalid_argument ("Invalid element index") ;
+		return mElementList[element_index] ;
+	}
+
+	PROPERTY &property_of (const my_index_t &element_index ,const my_index_t &property_index) {
+		auto &r1x = element_of (element_index) ;
+		if (property_index < 0 || property_index >= (INDEX)r1x.mPropertyList.size ())
+			throw std::invalid_argument ("Invalid property index") ;
+		return r1x.mPropertyList[property_index] ;
+	}
+
+	void check_bound (const INDEX &element_index) const {
+		const auto &r1x = mElementList[element_index] ;
+		for (auto &&i : r1x.mPropertyList)
+		{
+			if (i.mAddress == NULL && r1x.mSize != 0)
+				throw std::invalid_argument ("Property without data: " + r1x.mName + "." + i.mName) ;
+		}
+	}
+
+	void check_complete (const INDEX &element_index) const {
+		const auto &r1x = mElementList[element_index] ;
+		if (r1x.mSize >= 0 && mStreamCount[element_index] != r1x.mSize)
+			throw std::invalid_argument ("Fewer rows than declared: " + r1x.mName) ;
+	}
+
+	void open_stream () {
+		mStreamWriter.reset (new BlockWriter (mPlyFile ,mBufferSize)) ;
+		mStreamElement = 0 ;
+		mStreamCount.assign (mElementList.size () ,0) ;
+		const auto r1x = header_text () ;
+		mStreamWriter->write (r1x.data () ,LENGTH (r1x.size ())) ;
+	}
+
+	void close_file () {
+		mPlyFile.close () ;
+		if (mPlyFile.fail ())
+			throw util::FileException (mFile ,"Failed to close PLY file") ;
+	}
+
+	// a size of -1 is written as a blank field of PLYWRITER_COUNT_WIDTH characters whose
+	// position is kept in mCountOffset
+	std::string header_text () {
+		std::string ret = "ply\nformat " + mFormatName + " 1.0\n" ;
+		for (auto &&i : mComment)
+			ret += "comment " + i + "\n" ;
+		mCountOffset.assign (mElementList.size () ,-1) ;
+		for (INDEX k = 0 ; k < (INDEX)mElementList.size () ; ++k)
+		{
+			const auto &i = mElementList[k] ;
+			ret += "element " + i.mName + " " ;
+			if (i.mSize >= 0)
+			{
+				ret += std::to_string (i.mSize) ;
+			}
+			else
+			{
+				mCountOffset[k] = LENGTH (ret.size ()) ;
+				ret += std::string (PLYWRITER_COUNT_WIDTH ,' ') ;
+			}
+			ret += "\n" ;
+			for (auto &&j : i.mPropertyList)
+			{
+				if (j.mListType == PLYREADER_PROPERY_TYPE_NULL)
+					ret += std::string ("property ") + ply_type_name (j.mType) + " " + j.mName + "\n" ;
+				else
+					ret += std::string ("property list ") + ply_type_name (j.mType) + " " + ply_type_name (j.mListType) + " " + j.mName + "\n" ;
+			}
+		}
+		ret += "end_header\n" ;
+		return ret ;
+	}
+
+	vector<OPERATION> compile_plan (const INDEX &element_index) const {
+		const auto &r1x = mElementList[element_index] ;
+		const auto r2x = mFormat != PLY_ASCII && mFormat != PLY_BINARY_HOST ;
+		vector<OPERATION> ret ;
+
+		for (auto &&i : r1x.mPropertyList)
+		{
+			OPERATION r3x = {} ;
+			r3x.mProperty = &i ;
+			if (i.mListType == PLYREADER_PROPERY_TYPE_NULL)
+			{
+				r3x.mWidth = ply_type_width (i.mType) ;
+				r3x.mConvert = ply_converter (i.mSource ,i.mType) ;
+				r3x.mFormat = ply_formatter (i.mType) ;
+			}
+			else
+			{
+				r3x.mWidth = ply_type_width (i.mListType) ;
+				r3x.mCountWidth = ply_type_width (i.mType) ;
+				r3x.mConvert = ply_converter (i.mSource ,i.mListType) ;
+				r3x.mCount = ply_converter (PLYREADER_PROPERY_TYPE_VAR64 ,i.mType) ;
+				r3x.mFormat = ply_formatter (i.mListType) ;
+				r3x.mCountFormat = ply_formatter (i.mType) ;
+				r3x.mCountSwap = r2x ? ply_swapper (r3x.mCountWidth) : NULL ;
+			}
+			r3x.mSwap = r2x ? ply_swapper (r3x.mWidth) : NULL ;
+			r3x.mScatter = ply_scatterer (r3x.mWidth) ;
+			ret.push_back (r3x) ;
+		}
+		return ret ;
+	}
+
+	void write_rows (const INDEX &element_index ,const LENGTH &size ,BlockWriter &writer) {
+		if (size == 0)
+			return ;
+		encode_rows (element_index ,compile_plan (element_index) ,0 ,size ,writer) ;
+	}
+
+	void encode_rows (const INDEX &element_index ,const vector<OPERATION> &plan ,const INDEX &begin ,const INDEX &end ,BlockWriter &writer) const {
+		if (mFormat == PLY_ASCII)
+			write_element_text (plan ,begin ,end ,writer) ;
+		else if (mElementList[element_index].mStride >= 0)
+			write_element_fixed (element_index ,plan ,begin ,end ,writer) ;
+		else
+			write_element_variable (plan ,begin ,end ,writer) ;
+	}
+
+	// row ranges are encoded concurrently into their own buffers and written with positional
+	// writes; fixed-stride binary ranges know their file offset up front, the others are
+	// placed by the prefix sum of the encoded sizes. returns the offset after the element
+	LENGTH write_rows_parallel (const INDEX &element_index ,const LENGTH &offset ,util::system::PositionalFile &file) {
+		const auto &r1x = mElementList[element_index] ;
+		const auto r3x = mFormat != PLY_ASCII && r1x.mStride >= 0 ;
+		if (r1x.mSize == 0 || (r3x && r1x.mStride == 0))
+			return offset ;
+		const auto r2x = compile_plan (element_index) ;
+		const auto r4x = r3x ? std::max (LENGTH (1) ,mBufferSize / r1x.mStride) : PLYWRITER_BLOCK_ROWS ;
+		vector<std::unique_ptr<BlockWriter>> r5x (mThreadCount) ;
+		for (auto &&i : r5x)
+			i.reset (new BlockWriter (r3x ? r4x * r1x.mStride : mBufferSize)) ;
+		vector<LENGTH> r6x (mThreadCount + 1) ;
+		auto ret = offset ;
+
+		for (INDEX k = 0 ; k < r1x.mSize ; k += r4x * mThreadCount)
+		{
+			const auto r7x = (std::min (r4x * mThreadCount ,r1x.mSize - k) + r4x - 1) / r4x ;
+			util::system::parallel_for (r7x ,r7x ,[&] (std::size_t begin ,std::size_t end) {
+				for (auto t = begin ; t < end ; ++t)
+				{
+					const auto r8x = k + INDEX (t) * r4x ;
+					auto &r9x = *r5x[t] ;
+					r9x.clear () ;
+					encode_rows (element_index ,r2x ,r8x ,std::min (r8x + r4x ,r1x.mSize) ,r9x) ;
+					if (r3x && !file.write (r9x.data () ,r9x.size () ,offset + r8x * r1x.mStride))
+						throw util::FileException (mFile ,std::strerror (errno)) ;
+				}
+			}) ;
+			r6x[0] = ret ;
+			for (INDEX t = 0 ; t < r7x ; ++t)
+				r6x[t + 1] = r6x[t] + r5x[t]->size () ;
+			if (!r3x)
+			{
+				util::system::parallel_for (r7x ,r7x ,[&] (std::size_t begin ,std::size_t end) {
+					for (auto t = begin ; t < end ; ++t)
+					{
+						if (!file.write (r5x[t]->data () ,r5x[t]->size () ,r6x[t]))
+							throw util::FileException (mFile ,std::strerror (errno)) ;
+					}
+				}) ;
+			}
+			ret = r6x[r7x] ;
+		}
+		return ret ;
+	}
+
+	// whole row blocks are filled column by column; swapped columns are converted into a
+	// contiguous scratch first so the bulk byte-swap kernels apply
+	void write_element_fixed (const INDEX &element_index ,const vector<OPERATION> &plan ,const INDEX &begin ,const INDEX &end ,BlockWriter &writer) const {
+		const auto &r1x = mElementList[element_index] ;
+		if (r1x.mStride == 0)
+			return ;
+		const auto r2x = std::max (LENGTH (1) ,writer.capacity () / r1x.mStride) ;
+		vector<BYTE> r3x ;
+
+		for (INDEX k = begin ; k < end ; k += r2x)
+		{
+			const auto r4x = std::min (r2x ,end - k) ;
+			const auto r5x = writer.require (r4x * r1x.mStride) ;
+			for (auto &&i : plan)
+			{
+				const auto &r6x = *i.mProperty ;
+				const auto r7x = r6x.mAddress + k * r6x.mStride ;
+				if (i.mSwap == NULL)
+				{
+					i.mConvert (r7x ,r6x.mStride ,r5x + r6x.mOffset ,r1x.mStride ,r4x) ;
+					continue ;
+				}
+				r3x.resize (r4x * i.mWidth) ;
+				i.mConvert (r7x ,r6x.mStride ,r3x.data () ,i.mWidth ,r4x) ;
+				i.mSwap (r3x.data () ,r4x) ;
+				i.mScatter (r3x.data () ,r5x + r6x.mOffset ,r1x.mStride ,r4x) ;
+			}
+			writer.advance (r4x * r1x.mStride) ;
+		}
+	}
+
+	void write_element_variable (const vector<OPERATION> &plan ,const INDEX &begin ,const INDEX &end ,BlockWriter &writer) const {
+		for (INDEX k = begin ; k < end ; ++k)
+		{
+			LENGTH r1x = 0 ;
+			for (auto &&i : plan)
+			{
+				if (i.mProperty->mList == NULL)
+					r1x += i.mWidth ;
+				else
+					r1x += i.mCountWidth + list_size (*i.mProperty ,k) * i.mWidth ;
+			}
+			auto r2x = writer.require (r1x) ;
+			for (auto &&i : plan)
+				r2x = encode_cell (i ,k ,r2x) ;
+			writer.advance (r1x) ;
+		}
+	}
+
+	BYTE *encode_cell (const OPERATION &operation ,const INDEX &line ,BYTE *dest) const {
+		const auto &r1x = *operation.mProperty ;
+		if (r1x.mList == NULL)
+		{
+			operation.mConvert (r1x.mAddress + line * r1x.mStride ,r1x.mStride ,dest ,operation.mWidth ,1) ;
+			if (operation.mSwap != NULL)
+				operation.mSwap (dest ,1) ;
+			return dest + operation.mWidth ;
+		}
+
+		const auto r2x = list_size (r1x ,line) ;
+		operation.mCount (reinterpret_cast<const BYTE *> (&r2x) ,0 ,dest ,0 ,1) ;
+		if (operation.mCountSwap != NULL)
+			operation.mCountSwap (dest ,1) ;
+		dest += operation.mCountWidth ;
+		operation.mConvert (r1x.mAddress + r1x.mList[line] * r1x.mStride ,r1x.mStride ,dest ,operation.mWidth ,r2x) ;
+		if (operation.mSwap != NULL)
+			operation.mSwap (dest ,r2x) ;
+		return dest + r2x * operation.mWidth ;
+	}
+
+	// one line per row with single spaces between values
+	void write_element_text (const vector<OPERATION> &plan ,const INDEX &begin ,const INDEX &end ,BlockWriter &writer) const {
+		static constexpr auto r1x = LENGTH (util::formatter::MAX_NUMBER_LENGTH + 1) ;
+
+		for (INDEX k = begin ; k < end ; ++k)
+		{
+			LENGTH r2x = 0 ;
+			for (auto &&i : plan)
+				r2x += i.mProperty->mList == NULL ? 1 : 1 + list_size (*i.mProperty ,k) ;
+			const auto r3x = reinterpret_cast<char *> (writer.require (std::max (r2x ,LENGTH (1)) * r1x + 1)) ;
+			auto r4x = r3x ;
+			for (auto &&i : plan)
+				r4x = format_cell (i ,k ,r4x) ;
+			if (r4x > r3x)
+				--r4x ;
+			*r4x++ = '\n' ;
+			writer.advance (r4x - r3x) ;
+		}
+	}
+
+	char *format_cell (const OPERATION &operation ,const INDEX &line ,char *dest) const {
+		const auto &r1x = *operation.mProperty ;
+		BYTE r2x[8] ;
+		if (r1x.mList == NULL)
+		{
+			operation.mConvert (r1x.mAddress + line * r1x.mStride ,r1x.mStride ,r2x ,operation.mWidth ,1) ;
+			dest = operation.mFormat (r2x ,dest) ;
+			*dest++ = ' ' ;
+			return dest ;
+		}
+
+		const auto r3x = list_size (r1x ,line) ;
+		operation.mCount (reinterpret_cast<const BYTE *> (&r3x) ,0 ,r2x ,0 ,1) ;
+		dest = operation.mCountFormat (r2x ,dest) ;
+		*dest++ = ' ' ;
+		const auto r4x = r1x.mAddress + r1x.mList[line] * r1x.mStride ;
+		for (INDEX t = 0 ; t < r3x ; ++t)
+		{
+			operation.mConvert (r4x + t * r1x.mStride ,r1x.mStride ,r2x ,operation.mWidth ,1) ;
+			dest = operation.mFormat (r2x ,dest) ;
+			*dest++ = ' ' ;
+		}
+		return dest ;
+	}
+
+	static LENGTH list_size (const PROPERTY &property ,const INDEX &line) {
+		const auto ret = property.mList[line + 1] - property.mList[line] ;
+		if (ret < 0)
+			throw std::invalid_argument ("Invalid list offsets: " + property.mName) ;
+		return ret ;
+	}
+} ;
+
+
+void PlyWriter::check_avaliable (const std::shared_ptr<Implement> &pointer) {
+	assert (pointer != nullptr) ;
+}
+
+void PlyWriter::add_comment (const my_string_t &comment) {
+	check_avaliable (mPointer) ;
+	mPointer->add_comment (comment) ;
+}
+
+PlyWriter::my_index_t PlyWriter::add_element (const my_string_t &name ,const LENGTH &size) {
+	check_avaliable (mPointer) ;
+	return mPointer->add_element (name ,size) ;
+}
+
+PlyWriter::my_index_t PlyWriter::add_property (const my_index_t &element_index ,const my_string_t &name ,const FLAG &type) {
+	check_avaliable (mPointer) ;
+	return mPointer->add_property (element_index ,name ,type ,PLYREADER_PROPERY_TYPE_NULL) ;
+}
+
+PlyWriter::my_index_t PlyWriter::add_list_property (const my_index_t &element_index ,const my_string_t &name ,const FLAG &size_type ,const FLAG &type) {
+	check_avaliable (mPointer) ;
+	return mPointer->add_property (element_index ,name ,size_type ,type) ;
+}
+
+void PlyWriter::set_column (const my_index_t &element_index ,const my_index_t &property_index ,const void *src ,const LENGTH &stride ,const FLAG &type) {
+	check_avaliable (mPointer) ;
+	mPointer->set_column (element_index ,property_index ,src ,stride ,type) ;
+}
+
+void PlyWriter::set_list (const my_index_t &element_index ,const my_index_t &property_index ,const LENGTH *offset ,const void *src ,const FLAG &type) {
+	check_avaliable (mPointer) ;
+	mPointer->set_list (element_index ,property_index ,offset ,src ,type) ;
+}
+
+void PlyWriter::set_record (const my_index_t &element_index ,const vector<my_string_t> &property ,const void *src ,const LENGTH &stride) {
+	check_avaliable (mPointer) ;
+	mPointer->set_record (element_index ,property ,src ,stride) ;
+}
+
+void PlyWriter::write () {
+	check_avaliable (mPointer) ;
+	mPointer->write () ;
+}
+
+void PlyWriter::append_rows (const my_index_t &element_index ,const LENGTH &size) {
+	check_avaliable (mPointer) ;
+	mPointer->append_rows (element_index ,size) ;
+}
+
+void PlyWriter::close () {
+	check_avaliable (mPointer) ;
+	mPointer->close () ;
+}
+
+// declares the kept part of reader in writer and streams its rows through append_rows
+static void ply_rewrite (const PlyReader &r2x ,const PlyWriter::REWRITE &rewrite ,PlyWriter &r6x) {
+	// kept property names of every element, the type each is written in and whether the
+	// values go through ply_color_convert; elements left without properties are dropped
+	vector<vector<string>> r3x (r2x.element_count ()) ;
+	vector<vector<FLAG>> r4x (r2x.element_count ()) ;
+	vector<vector<BOOL>> r5x (r2x.element_count ()) ;
+	for (auto &&i : r2x.comment_list ())
+		r6x.add_comment (i) ;
+	vector<INDEX> r7x (r2x.element_count () ,-1) ;
+	for (INDEX i = 0 ; i < r2x.element_count () ; ++i)
+	{
+		const auto r8x = r2x.element_name (i) ;
+		const auto r9x = rewrite.mProjection.find (r8x) ;
+		if (!rewrite.mProjection.empty () && r9x == rewrite.mProjection.end ())
+			continue ;
+		const auto r10x = rewrite.mType.find (r8x) ;
+		for (INDEX j = 0 ; j < r2x.property_count (i) ; ++j)
+		{
+			const auto r11x = r2x.property_name (i ,j) ;
+			if (r9x != rewrite.mProjection.end () && !r9x->second.empty () && std::find (r9x->second.begin () ,r9x->second.end () ,r11x) == r9x->second.end ())
+				continue ;
+			const auto r12x = r2x.property_list_type (i ,j) ;
+			auto r13x = r12x == PLYREADER_PROPERY_TYPE_NULL ? r2x.property_type (i ,j) : r12x ;
+			const auto r14x = r13x == PLYREADER_PROPERY_TYPE_VAL32 || r13x == PLYREADER_PROPERY_TYPE_VAL64 ;
+			auto r15x = false ;
+			if (r10x != rewrite.mType.end () && r10x->second.count (r11x) != 0)
+			{
+				r13x = r10x->second.at (r11x) ;
+			}
+			else if (rewrite.mNarrowColor && r14x && r12x == PLYREADER_PROPERY_TYPE_NULL && (r11x == "red" || r11x == "green" || r11x == "blue" || r11x == "alpha"))
+			{
+				r13x = PLYREADER_PROPERY_TYPE_BYTE ;
+				r15x = true ;
+			}
+			else if (rewrite.mNarrowReal && r13x == PLYREADER_PROPERY_TYPE_VAL64)
+			{
+				r13x = PLYREADER_PROPERY_TYPE_VAL32 ;
+			}
+			r3x[i].push_back (r11x) ;
+			r4x[i].push_back (r13x) ;
+			r5x[i].push_back (r15x) ;
+		}
+		if (r3x[i].empty ())
+			continue ;
+		r7x[i] = r6x.add_element (r8x ,r2x.element_size (i)) ;
+		for (INDEX j = 0 ; j < (INDEX)r3x[i].size () ; ++j)
+		{
+			const auto r16x = r2x.find_property (i ,r3x[i][j]) ;
+			if (r2x.property_list_type (i ,r16x) == PLYREADER_PROPERY_TYPE_NULL)
+				r6x.add_property (r7x[i] ,r3x[i][j] ,r4x[i][j]) ;
+			else
+				r6x.add_list_property (r7x[i] ,r3x[i][j] ,r2x.property_type (i ,r16x) ,r4x[i][j]) ;
+		}
+	}
+
+	PlyReader::CURSOR r17x ;
+	BOOL r18x = false ;
+	vector<vector<BYTE>> r19x ;
+	for (INDEX i = 0 ; i < r2x.element_count () ; ++i)
+	{
+		if (r7x[i] < 0)
+			continue ;
+		if (!r18x)
+			r17x = PlyReader::CURSOR (r2x ,r2x.element_name (i) ,r3x[i]) ;
+		else
+			r17x.open_element (r2x.element_name (i) ,r3x[i]) ;
+		r18x = true ;
+		r19x.resize (r3x[i].size ()) ;
+		while (true)
+		{
+			const auto &r20x = r17x.next_batch (PLYWRITER_BATCH_ROWS) ;
+			if (r20x.mSize == 0)
+				break ;
+			for (INDEX j = 0 ; j < (INDEX)r20x.mColumn.size () ; ++j)
+			{
+				const auto &r21x = r20x.mColumn[j] ;
+				// colors are scaled by ply_color_convert rather than cast, so they are not checked
+				const auto r22x = r5x[i][j] ? NULL : ply_fitter (r21x.mType ,r4x[i][j]) ;
+				if (r22x != NULL && !r22x (r21x.mAddress ,r21x.mStride ,r21x.mSize))
+					throw util::Exception ("Values do not fit the narrowed type: " + r2x.element_name (i) + "." + r3x[i][j]) ;
+				if (r5x[i][j])
+				{
+					r19x[j].resize (r21x.mSize) ;
+					for (INDEX k = 0 ; k < r21x.mSize ; ++k)
+					{
+						const auto r23x = VAL32 (ply_load_scalar<VAL32> (r21x.mAddress + k * r21x.mStride ,r21x.mType)) ;
+						ply_color_convert (&r23x ,&r19x[j][k] ,1) ;
+					}
+					r6x.set_column (r7x[i] ,j ,r19x[j].data ()) ;
+				}
+				else if (r20x.mOffset[j] == NULL)
+				{
+					r6x.set_column (r7x[i] ,j ,r21x.mAddress ,r21x.mStride ,r21x.mType) ;
+				}
+				else
+				{
+					r6x.set_list (r7x[i] ,j ,r20x.mOffset[j] ,r21x.mAddress ,r21x.mType) ;
+				}
+			}
+			r6x.append_rows (r7x[i] ,r20x.mSize) ;
+		}
+	}
+}
+
+void PlyWriter::convert (const my_string_t &src ,const my_string_t &file ,const OPTION &option) {
+	rewrite (src ,file ,option ,REWRITE ()) ;
+}
+
+// rows go to file.part, which replaces file only once it is complete, so a failed rewrite
+// leaves neither a truncated file nor a changed one behind
+void PlyWriter::rewrite (const my_string_t &src ,const my_string_t &file ,const OPTION &option ,const REWRITE &rewrite) {
+	PlyReader::OPTION r1x ;
+	r1x.mMapping = true ;
+	r1x.mLazy = true ;
+	r1x.mThreadCount = option.mThreadCount ;
+	r1x.mBufferSize = option.mBufferSize ;
+	const PlyReader r2x (src ,r1x) ;
+
+	const auto r3x = file + ".part" ;
+	try
+	{
+		PlyWriter r4x (r3x ,option) ;
+		ply_rewrite (r2x ,rewrite ,r4x) ;
+		r4x.close () ;
+	}
+	catch (...)
+	{
+		std::remove (r3x.c_str ()) ;
+		throw ;
+	}
+	if (!util::system::replace_file (r3x ,file))
+	{
+		const auto r5x = std::strerror (errno) ;
+		std::remove (r3x.c_str ()) ;
+		throw util::FileException (file ,r5x) ;
+	}
+}
+
+std::shared_ptr<PlyWriter::Implement> PlyWriter::create (const my_string_t &file ,const OPTION &option) {
+	return std::make_shared<Implement> (file ,option) ;
+}
+
+};
@@ -3,15 +3,146 @@
 #include <iostream>
 #include <cstdlib>
 #include <csignal>
+#include <cerrno>
 #if defined(__GLIBC__) && !defined(_WIN32) && !defined(__CYGWIN__)
 #   include <execinfo.h> 
 #endif
 
+#include <cstdio>
+#if defined(_WIN32)
+#   include <windows.h>
+#endif
+#if !defined(_WIN32)
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#   include <immintrin.h>
+#   define UTIL_SYSTEM_X86_SIMD
+#endif
+
 #include "system.h"
 
 namespace util {
 namespace system {
 
+namespace {
+
+template <int N>
+void
+byte_swap_scalar (char* data, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; ++i)
+        byte_swap<N>(data + i * N);
+}
+
+#if defined(UTIL_SYSTEM_X86_SIMD)
+
+/* Byte indices reversing every N-byte group of a 16-byte lane. */
+template <int N>
+struct ByteSwapMask
+{
+    alignas(32) char index[32];
+
+    ByteSwapMask (void)
+    {
+        for (int i = 0; i < 32; ++i)
+            index[i] = (char)((i % 16) / N * N + (N - 1 - i % N));
+    }
+};
+
+template <int N>
+__attribute__((target("ssse3")))
+std::size_t
+byte_swap_ssse3 (char* data, std::size_t count)
+{
+    static ByteSwapMask<N> const mask;
+    __m128i const shuffle = _mm_load_si128(
+        reinterpret_cast<__m128i const*>(mask.index));
+    std::size_t const bytes = count * N;
+    std::size_t i = 0;
+    for (; i + 16 <= bytes; i += 16)
+    {
+        __m128i* ptr = reinterpret_cast<__m128i*>(data + i);
+        _mm_storeu_si128(ptr, _mm_shuffle_epi8(_mm_loadu_si128(ptr), shuffle));
+    }
+    return i / N;
+}
+
+template <int N>
+__attribute__((target("avx2")))
+std::size_t
+byte_swap_avx2 (char* data, std::size_t count)
+{
+    static ByteSwapMask<N> const mask;
+    __m256i const shuffle = _mm256_load_si256(
+        reinterpret_cast<__m256i const*>(mask.index));
+    std::size_t const bytes = count * N;
+    std::size_t i = 0;
+    for (; i + 32 <= bytes; i += 32)
+    {
+        __m256i* ptr = reinterpret_cast<__m256i*>(data + i);
+        _mm256_storeu_si256(ptr,
+            _mm256_shuffle_epi8(_mm256_loadu_si256(ptr), shuffle));
+    }
+    return i / N;
+}
+
+#endif
+
+template <int N>
+void
+byte_swap_dispatch (char* data, std::size_t count)
+{
+    std::size_t done = 0;
+#if defined(UTIL_SYSTEM_X86_SIMD)
+    static int const level = []
+    {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            return 2;
+        if (__builtin_cpu_supports("ssse3"))
+            return 1;
+        return 0;
+    }();
+    if (level == 2)
+        done = byte_swap_avx2<N>(data, count);
+    else if (level == 1)
+        done = byte_swap_ssse3<N>(data, count);
+#endif
+    byte_swap_scalar<N>(data + done * N, count - done);
+}
+
+}
+
+
+template <>
+void
+byte_swap_block<2> (char* data, std::size_t count)
+{
+    byte_swap_dispatch<2>(data, count);
+}
+
+
+template <>
+void
+byte_swap_block<4> (char* data, std::size_t count)
+{
+    byte_swap_dispatch<4>(data, count);
+}
+
+
+template <>
+void
+byte_swap_block<8> (char* data, std::size_t count)
+{
+    byte_swap_dispatch<8>(data, count);
+}
+
+
 
 void
 print_build_timestamp (char const* application_name,
@@ -39,6 +170,138 @@ signal_segfault_handler (int code)
 }
 
 
+MappedFile::MappedFile (void)
+    : address(nullptr), length(0)
+{
+}
+
+
+MappedFile::~MappedFile (void)
+{
+    this->close();
+}
+
+
+bool
+MappedFile::open (std::string const& filename)
+{
+    this->close();
+#if !defined(_WIN32)
+    int const fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || info.st_size <= 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void* ptr = ::mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (ptr == MAP_FAILED)
+        return false;
+
+    this->address = ptr;
+    this->length = info.st_size;
+    return true;
+#else
+    (void)filename;
+    return false;
+#endif
+}
+
+
+void
+MappedFile::close (void)
+{
+#if !defined(_WIN32)
+    if (this->address != nullptr)
+        ::munmap(this->address, this->length);
+#endif
+    this->address = nullptr;
+    this->length = 0;
+}
+
+
+PositionalFile::PositionalFile (void)
+    : handle(-1)
+{
+}
+
+
+PositionalFile::~PositionalFile (void)
+{
+    this->close();
+}
+
+
+bool
+PositionalFile::open (std::string const& filename)
+{
+    this->close();
+#if !defined(_WIN32)
+    this->handle = ::open(filename.c_str(), O_WRONLY);
+    return this->handle >= 0;
+#else
+    (void)filename;
+    return false;
+#endif
+}
+
+
+void
+PositionalFile::close (void)
+{
+#if !defined(_WIN32)
+    if (this->handle >= 0)
+        ::close(this->handle);
+#endif
+    this->handle = -1;
+}
+
+
+bool
+PositionalFile::write (void const* data, std::size_t size, std::size_t offset)
+{
+#if !defined(_WIN32)
+    char const* pos = static_cast<char const*>(data);
+    while (size > 0)
+    {
+        ssize_t const written = ::pwrite(this->handle, pos, size, offset);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0)
+            return false;
+        pos += written;
+        size -= written;
+        offset += written;
+    }
+    return true;
+#else
+    (void)data;
+    (void)size;
+    (void)offset;
+    return false;
+#endif
+}
+
+
+bool
+replace_file (std::string const& from, std::string const& to)
+{
+#if !defined(_WIN32)
+    return std::rename(from.c_str(), to.c_str()) == 0;
+#else
+    if (::MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING))
+        return true;
+    errno = EACCES;
+    return false;
+#endif
+}
+
+
 void
 print_stack_trace (void)
 {
@@ -1,4 +1,5 @@
 ﻿#include "PlyReader.h"
+#include "PlyWriter.h"
 #include <memory>
 #include <assert.h>
 #include <iostream>
@@ -38,44 +39,19 @@ void plyreader (std::string const& path ,std::string const& path2)
 		const auto r11x = reader->find_property (r2x , "blue") ;
 		assert(r11x != -1) ;
 
-		std::ofstream out(path2.c_str(), std::ios::binary);
-		out << "ply" << "\n";
-		out << "format binary_little_endian 1.0" << "\n";
-		out << "comment Export generated by 4dkk" << "\n";
-		out << "element vertex " << r02x << "\n";
-		out << "property float x" << "\n";
-		out << "property float y" << "\n";
-		out << "property float z" << "\n";
-		out << "property float nx" << "\n";
-		out << "property float ny" << "\n";
-		out << "property float nz" << "\n";
-		out << "property uchar red" << "\n";
-		out << "property uchar green" << "\n";
-		out << "property uchar blue" << "\n";
-		out << "end_header" << "\n";
+		const auto r12x = LENGTH (6 * sizeof (float) + 3) ;
+		std::vector<BYTE> r13x (r02x * r12x) ;
+		reader->read_record<VAL32 ,VAL32 ,VAL32 ,VAL32 ,VAL32 ,VAL32 ,BYTE ,BYTE ,BYTE> (r2x ,{"x" ,"y" ,"z" ,"nx" ,"ny" ,"nz" ,"red" ,"green" ,"blue"} ,r13x.data () ,r12x) ;
 
-		for (int i = 0 ; i < r02x ; ++i)
-		{
-
-			float v[3];
-			float n[3];
-			unsigned char color[3];
-			v[0] = static_cast<float> (reader->get_value (r2x , i ,r3x)) ;
-			v[1] = static_cast<float> (reader->get_value (r2x , i ,r4x)) ;
-			v[2] = static_cast<float> (reader->get_value (r2x , i ,r5x)) ;
-			n[0] = static_cast<float> (reader->get_value (r2x , i ,r6x)) ;
-			n[1] = static_cast<float> (reader->get_value (r2x , i ,r7x)) ;
-			n[2] = static_cast<float> (reader->get_value (r2x , i ,r8x)) ;
-			color[0] = static_cast<unsigned char> (reader->get_byte (r2x , i ,r9x)) ;
-			color[1] = static_cast<unsigned char> (reader->get_byte (r2x , i ,r10x)) ;
-			color[2] = static_cast<unsigned char> (reader->get_byte (r2x , i ,r11x)) ;
-
-			out.write((char const*)v, 3 * sizeof(float));
-			out.write((char const*)n, 3 * sizeof(float));
-			out.write((char const*)color, 3);
-		}
-
-		out.close ();
+		PlyWriter writer (path2) ;
+		writer.add_comment ("Export generated by 4dkk") ;
+		const auto r14x = writer.add_element ("vertex" ,r02x) ;
+		for (auto &&i : {"x" ,"y" ,"z" ,"nx" ,"ny" ,"nz"})
+			writer.add_property (r14x ,i ,PLYREADER_PROPERY_TYPE_VAL32) ;
+		for (auto &&i : {"red" ,"green" ,"blue"})
+			writer.add_property (r14x ,i ,PLYREADER_PROPERY_TYPE_BYTE) ;
+		writer.set_record (r14x ,{"x" ,"y" ,"z" ,"nx" ,"ny" ,"nz" ,"red" ,"green" ,"blue"} ,r13x.data () ,r12x) ;
+		writer.write () ;
 	}
 
 }
@@ -0,0 +1,214 @@
+#include "PlyReader.h"
+#include "PlyWriter.h"
+#include <cstdio>
+#include <clocale>
+#include <functional>
+#include <iostream>
+#include <string>
+
+using namespace SOLUTION;
+
+// every element, property, cell and list of actual must match expected byte for byte
+static LENGTH compare (const PlyReader &actual ,const PlyReader &expected)
+{
+	if (actual.element_count () != expected.element_count ())
+		return 1 ;
+	LENGTH ret = 0 ;
+	for (INDEX i = 0 ; i < actual.element_count () ; ++i)
+	{
+		const auto r1x = actual.element_size (i) ;
+		if (actual.element_name (i) != expected.element_name (i) || r1x != expected.element_size (i) || actual.property_count (i) != expected.property_count (i))
+			return ret + 1 ;
+		for (INDEX j = 0 ; j < actual.property_count (i) ; ++j)
+		{
+			const auto r2x = actual.property_type (i ,j) ;
+			const auto r3x = actual.property_list_type (i ,j) ;
+			if (actual.property_name (i ,j) != expected.property_name (i ,j) || r2x != expected.property_type (i ,j) || r3x != expected.property_list_type (i ,j))
+				return ret + 1 ;
+			if (r3x == PLYREADER_PROPERY_TYPE_NULL)
+			{
+				const auto r4x = actual.get_column (i ,j) ;
+				const auto r5x = expected.get_column (i ,j) ;
+				for (INDEX k = 0 ; k < r1x ; ++k)
+				{
+					if (std::memcmp (r4x.mAddress + k * r4x.mStride ,r5x.mAddress + k * r5x.mStride ,ply_type_width (r2x)) != 0)
+					{
+						std::cerr << "  " << actual.element_name (i) << "." << actual.property_name (i ,j) << " differs at row " << k << std::endl ;
+						ret++ ;
+					}
+				}
+				continue ;
+			}
+			for (INDEX k = 0 ; k < r1x ; ++k)
+			{
+				const auto r4x = actual.get_list (i ,k ,j) ;
+				const auto r5x = expected.get_list (i ,k ,j) ;
+				if (r4x.mSize != r5x.mSize || (r4x.mSize > 0 && std::memcmp (r4x.mAddress ,r5x.mAddress ,r4x.mSize * ply_type_width (r3x)) != 0))
+				{
+					std::cerr << "  " << actual.element_name (i) << "." << actual.property_name (i ,j) << " differs at row " << k << std::endl ;
+					ret++ ;
+				}
+			}
+		}
+	}
+	return ret ;
+}
+
+// runs one case, reporting it and returning its failure count
+static LENGTH check (const std::string &name ,const std::function<LENGTH ()> &func)
+{
+	LENGTH ret = 0 ;
+	try
+	{
+		ret = func () ;
+	}
+	catch (const std::exception &e)
+	{
+		std::cerr << "  " << e.what () << std::endl ;
+		ret = 1 ;
+	}
+	std::cout << (ret == 0 ? "ok    " : "FAIL  ") << name << std::endl ;
+	return ret ;
+}
+
+// an element large enough for whole byte-swap blocks and several writer row ranges, with
+// every scalar width and lists of 0 to 4 values
+static void write_sample (const std::string &file ,const PlyWriter::OPTION &option)
+{
+	const auto r1x = LENGTH (5000) ;
+	vector<VAL32> r2x (r1x) ;
+	vector<VAL64> r3x (r1x) ;
+	vector<BYTE> r4x (r1x) ;
+	vector<WORD> r5x (r1x) ;
+	vector<VAR32> r6x (r1x) ;
+	vector<LENGTH> r7x (1 ,0) ;
+	vector<VAR32> r8x ;
+	for (INDEX k = 0 ; k < r1x ; ++k)
+	{
+		r2x[k] = VAL32 (k) / 7 - 300 ;
+		r3x[k] = VAL64 (k) * 1e-3 / 3 + 1e10 ;
+		r4x[k] = BYTE (k * 37) ;
+		r5x[k] = WORD (k * 911) ;
+		r6x[k] = VAR32 (k * 104729) - 7 ;
+		for (INDEX j = 0 ; j < k % 5 ; ++j)
+			r8x.push_back (VAR32 (k + j)) ;
+		r7x.push_back (LENGTH (r8x.size ())) ;
+	}
+
+	PlyWriter r9x (file ,option) ;
+	const auto r10x = r9x.add_element ("vertex" ,r1x) ;
+	r9x.add_property (r10x ,"x" ,PLYREADER_PROPERY_TYPE_VAL32) ;
+	r9x.add_property (r10x ,"y" ,PLYREADER_PROPERY_TYPE_VAL64) ;
+	r9x.add_property (r10x ,"red" ,PLYREADER_PROPERY_TYPE_BYTE) ;
+	r9x.add_property (r10x ,"s" ,PLYREADER_PROPERY_TYPE_WORD) ;
+	r9x.add_property (r10x ,"id" ,PLYREADER_PROPERY_TYPE_VAR32) ;
+	r9x.set_column (r10x ,0 ,r2x.data ()) ;
+	r9x.set_column (r10x ,1 ,r3x.data ()) ;
+	r9x.set_column (r10x ,2 ,r4x.data ()) ;
+	r9x.set_column (r10x ,3 ,r5x.data ()) ;
+	r9x.set_column (r10x ,4 ,r6x.data ()) ;
+	const auto r11x = r9x.add_element ("face" ,r1x) ;
+	r9x.add_list_property (r11x ,"vertex_indices" ,PLYREADER_PROPERY_TYPE_BYTE ,PLYREADER_PROPERY_TYPE_VAR32) ;
+	r9x.add_property (r11x ,"flags" ,PLYREADER_PROPERY_TYPE_WORD) ;
+	r9x.set_list (r11x ,0 ,r7x.data () ,r8x.data ()) ;
+	r9x.set_column (r11x ,1 ,r5x.data ()) ;
+	r9x.write () ;
+}
+
+int main (int argc ,char **argv)
+{
+	if (argc != 2)
+	{
+		std::cerr << "Usage: " << argv[0] << " <test data directory>" << std::endl ;
+		return 1 ;
+	}
+	// parsing and formatting must not follow a comma LC_NUMERIC from the environment
+	std::setlocale (LC_ALL ,"") ;
+	const std::string r1x = std::string (argv[1]) + "/" ;
+
+	vector<pair<std::string ,PlyReader::OPTION>> r2x ;
+	{
+		PlyReader::OPTION r3x ;
+		r2x.emplace_back ("serial" ,r3x) ;
+		r3x.mThreadCount = 4 ;
+		r2x.emplace_back ("4 threads" ,r3x) ;
+		r3x.mBufferSize = 256 ;
+		r2x.emplace_back ("4 threads, 256 byte windows" ,r3x) ;
+		r3x.mBufferSize = LENGTH (1 << 20) ;
+		r3x.mMapping = true ;
+		r2x.emplace_back ("4 threads, mapped" ,r3x) ;
+		r3x.mThreadCount = 1 ;
+		r2x.emplace_back ("serial, mapped" ,r3x) ;
+	}
+	const vector<std::string> r4x {"ascii" ,"binary_little_endian" ,"binary_big_endian"} ;
+
+	const PlyReader r5x (r1x + "binary_le.ply") ;
+	LENGTH r6x = 0 ;
+	for (auto &&i : {"ascii_lf.ply" ,"ascii_crlf.ply" ,"ascii_no_newline.ply" ,"ascii_split.ply" ,"binary_be.ply"})
+	{
+		for (auto &&j : r2x)
+		{
+			r6x += check (std::string (i) + " (" + j.first + ")" ,[&] () {
+				return compare (PlyReader (r1x + i ,j.second) ,r5x) ;
+			}) ;
+		}
+	}
+
+	// a cursor built from a reader, streaming part of one element and then another, must leave
+	// the reader whole, whether the reader decoded an element before or not
+	for (auto &&i : {"binary_le.ply" ,"binary_be.ply" ,"ascii_lf.ply"})
+	{
+		for (auto &&j : r2x)
+		{
+			r6x += check (std::string ("cursor then reader on ") + i + " (" + j.first + ")" ,[&] () {
+				auto r7x = j.second ;
+				r7x.mLazy = true ;
+				const PlyReader r8x (r1x + i ,r7x) ;
+				const auto r9x = r8x.find_element ("vertex") ;
+				r8x.get_column (r9x ,r8x.find_property (r9x ,"id")) ;
+				LENGTH ret = 0 ;
+				{
+					PlyReader::CURSOR r10x (r8x ,"vertex" ,{"x"}) ;
+					LENGTH r11x = 0 ;
+					while (r10x.next_batch (4).mSize > 0)
+						r11x += 4 ;
+					r10x.open_element ("face" ,{"flags"}) ;
+					r10x.next_batch (2) ;
+					ret += r11x < r8x.element_size (r9x) ? 1 : 0 ;
+				}
+				return ret + compare (r8x ,r5x) ;
+			}) ;
+		}
+	}
+
+	// the fixture through the streaming converter and the sample through write, in every
+	// format and with serial and parallel encoding
+	PlyWriter::OPTION r7x ;
+	r7x.mBufferSize = 256 ;
+	write_sample ("ply_test_sample.ply" ,r7x) ;
+	const PlyReader r8x ("ply_test_sample.ply") ;
+	for (auto &&i : r4x)
+	{
+		for (auto &&j : {LENGTH (1) ,LENGTH (4)})
+		{
+			const auto r9x = i + ", " + std::to_string (j) + " thread(s)" ;
+			auto r10x = r7x ;
+			r10x.mFormat = i ;
+			r10x.mThreadCount = j ;
+			r6x += check ("convert to " + r9x ,[&] () {
+				PlyWriter::convert (r1x + "binary_le.ply" ,"ply_test_out.ply" ,r10x) ;
+				return compare (PlyReader ("ply_test_out.ply") ,r5x) ;
+			}) ;
+			r6x += check ("write " + r9x ,[&] () {
+				write_sample ("ply_test_out.ply" ,r10x) ;
+				auto r11x = compare (PlyReader ("ply_test_out.ply") ,r8x) ;
+				for (auto &&k : r2x)
+					r11x += compare (PlyReader ("ply_test_out.ply" ,k.second) ,r8x) ;
+				return r11x ;
+			}) ;
+		}
+	}
+	std::remove ("ply_test_sample.ply") ;
+	std::remove ("ply_test_out.ply") ;
+	return r6x == 0 ? 0 : 1 ;
+}
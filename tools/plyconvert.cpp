@@ -0,0 +1,122 @@
+#include "PlyWriter.h"
+#include <iostream>
+#include <string>
+#include <chrono>
+
+using namespace SOLUTION;
+
+static void usage (const char *name)
+{
+	std::cerr << "Usage: " << name << " [options] <input.ply> <output.ply> [format] [threads]" << std::endl ;
+	std::cerr << "  -f format             ascii, binary_little_endian or binary_big_endian" << std::endl ;
+	std::cerr << "  -j threads            worker threads, 0 for all cores" << std::endl ;
+	std::cerr << "  -k element[:a,b,...]  keep only the listed elements and properties" << std::endl ;
+	std::cerr << "  -t element.name=type  store a property in another type" << std::endl ;
+	std::cerr << "  -r                    store double properties as float" << std::endl ;
+	std::cerr << "  -c                    store float red, green, blue and alpha as uchar" << std::endl ;
+}
+
+int main (int argc ,char **argv)
+{
+	map<string ,FLAG> r1x ;
+	{
+		r1x.insert (pair<string ,FLAG> ("float" ,PLYREADER_PROPERY_TYPE_VAL32)) ;
+		r1x.insert (pair<string ,FLAG> ("double" ,PLYREADER_PROPERY_TYPE_VAL64)) ;
+		r1x.insert (pair<string ,FLAG> ("int" ,PLYREADER_PROPERY_TYPE_VAR32)) ;
+		r1x.insert (pair<string ,FLAG> ("int64" ,PLYREADER_PROPERY_TYPE_VAR64)) ;
+		r1x.insert (pair<string ,FLAG> ("uchar" ,PLYREADER_PROPERY_TYPE_BYTE)) ;
+		r1x.insert (pair<string ,FLAG> ("uint16" ,PLYREADER_PROPERY_TYPE_WORD)) ;
+		r1x.insert (pair<string ,FLAG> ("uint32" ,PLYREADER_PROPERY_TYPE_CHAR)) ;
+		r1x.insert (pair<string ,FLAG> ("uint64" ,PLYREADER_PROPERY_TYPE_DATA)) ;
+	}
+
+	PlyWriter::OPTION option ;
+	PlyWriter::REWRITE rewrite ;
+	vector<string> r2x ;
+	try
+	{
+		for (int i = 1 ; i < argc ; ++i)
+		{
+			const string r3x = argv[i] ;
+			if (r3x.size () != 2 || r3x[0] != '-')
+			{
+				r2x.push_back (r3x) ;
+				continue ;
+			}
+			if (r3x == "-r")
+			{
+				rewrite.mNarrowReal = true ;
+				continue ;
+			}
+			if (r3x == "-c")
+			{
+				rewrite.mNarrowColor = true ;
+				continue ;
+			}
+			if (i + 1 >= argc)
+				throw std::invalid_argument ("Missing value for " + r3x) ;
+			const string r4x = argv[++i] ;
+			if (r3x == "-f")
+			{
+				option.mFormat = r4x ;
+			}
+			else if (r3x == "-j")
+			{
+				option.mThreadCount = std::stoll (r4x) ;
+			}
+			else if (r3x == "-k")
+			{
+				const auto r5x = r4x.find (':') ;
+				auto &r6x = rewrite.mProjection[r4x.substr (0 ,r5x)] ;
+				for (auto r7x = r5x ; r7x != string::npos ;)
+				{
+					const auto r8x = r4x.find (',' ,r7x + 1) ;
+					r6x.push_back (r4x.substr (r7x + 1 ,r8x == string::npos ? string::npos : r8x - r7x - 1)) ;
+					r7x = r8x ;
+				}
+			}
+			else if (r3x == "-t")
+			{
+				const auto r5x = r4x.find ('.') ;
+				const auto r6x = r4x.find ('=' ,r5x == string::npos ? 0 : r5x) ;
+				if (r5x == string::npos || r6x == string::npos || r1x.count (r4x.substr (r6x + 1)) == 0)
+					throw std::invalid_argument ("Invalid type mapping: " + r4x) ;
+				rewrite.mType[r4x.substr (0 ,r5x)][r4x.substr (r5x + 1 ,r6x - r5x - 1)] = r1x[r4x.substr (r6x + 1)] ;
+			}
+			else
+			{
+				throw std::invalid_argument ("Unknown option: " + r3x) ;
+			}
+		}
+		if (r2x.size () > 2)
+			option.mFormat = r2x[2] ;
+		if (r2x.size () > 3)
+			option.mThreadCount = std::stoll (r2x[3]) ;
+	}
+	catch (const std::exception &e)
+	{
+		std::cerr << "plyconvert: " << e.what () << std::endl ;
+		usage (argv[0]) ;
+		return 1 ;
+	}
+	if (r2x.size () < 2 || r2x.size () > 4)
+	{
+		usage (argv[0]) ;
+		return 1 ;
+	}
+
+	const auto start = std::chrono::steady_clock::now () ;
+	try
+	{
+		PlyWriter::rewrite (r2x[0] ,r2x[1] ,option ,rewrite) ;
+	}
+	catch (const std::exception &e)
+	{
+		std::cerr << "plyconvert: " << e.what () << std::endl ;
+		return 1 ;
+	}
+	const auto end = std::chrono::steady_clock::now () ;
+
+	std::cout << std::chrono::duration<double> (end - start).count () << "s" << std::endl ;
+	return 0 ;
+}